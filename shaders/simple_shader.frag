@@ -7,8 +7,8 @@ layout (location = 0) out vec4 outColor;
 layout (set = 0, binding = 1) uniform sampler2D texSampler;
 
 layout (push_constant) uniform Push {
-    layout(offset = 64) vec3 color;
-    layout(offset = 80) float opacity;
+    layout(offset = 80) vec3 color;
+    layout(offset = 96) float opacity;
 } push;
 
 void main() {
@@ -13,10 +13,11 @@ layout (set = 0, binding = 0) uniform GlobalUbo {
 
 layout (push_constant) uniform Push {
     layout(offset = 0) mat4 model;
+    layout(offset = 64) vec4 uvRect;
 } push;
 
 void main() {
     gl_Position = ubo.projection * ubo.view * push.model * vec4(position, 0.0, 1.0);
 
-    fragTexCoord = texCoord;
+    fragTexCoord = push.uvRect.xy + texCoord * push.uvRect.zw;
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 450
+
+// already in world space, see SpriteBatch::Vertex
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec4 color;
+layout (location = 2) in vec2 texCoord;
+
+layout (location = 0) out vec2 fragTexCoord;
+layout (location = 1) out vec4 fragColor;
+
+layout (set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projection;
+    mat4 view;
+} ubo;
+
+void main() {
+    gl_Position = ubo.projection * ubo.view * vec4(position, 1.0);
+
+    fragTexCoord = texCoord;
+    fragColor = color;
+}
\ No newline at end of file
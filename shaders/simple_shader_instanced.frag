@@ -0,0 +1,12 @@
+#version 450
+
+layout (location = 0) in vec2 fragTexCoord;
+layout (location = 1) in vec4 fragColor;
+
+layout (location = 0) out vec4 outColor;
+
+layout (set = 0, binding = 1) uniform sampler2D texSampler;
+
+void main() {
+    outColor = fragColor * texture(texSampler, fragTexCoord);
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 450
+
+layout (location = 0) in vec2 position;
+layout (location = 1) in vec3 color;
+layout (location = 2) in vec2 texCoord;
+
+// per instance, see SimpleRenderSystem::Instance
+layout (location = 3) in vec4 instanceBasis;
+layout (location = 4) in vec3 instancePosition;
+layout (location = 5) in vec4 instanceColor;
+layout (location = 6) in vec4 instanceUvRect;
+
+layout (location = 0) out vec2 fragTexCoord;
+layout (location = 1) out vec4 fragColor;
+
+layout (set = 0, binding = 0) uniform GlobalUbo {
+    mat4 projection;
+    mat4 view;
+} ubo;
+
+void main() {
+    vec2 world = mat2(instanceBasis.xy, instanceBasis.zw) * position + instancePosition.xy;
+    gl_Position = ubo.projection * ubo.view * vec4(world, instancePosition.z, 1.0);
+
+    fragTexCoord = instanceUvRect.xy + texCoord * instanceUvRect.zw;
+    fragColor = instanceColor;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 450
+
+layout (location = 0) in vec2 fragTexCoord;
+layout (location = 1) in vec4 fragColor;
+
+layout (location = 0) out vec4 outColor;
+
+// every loaded texture, indexed by the index of its handle
+layout (set = 1, binding = 0) uniform sampler2D textures[4096];
+
+// one texture per instanced draw
+layout (push_constant) uniform Push {
+    layout(offset = 100) uint textureIndex;
+} push;
+
+void main() {
+    outColor = fragColor * texture(textures[push.textureIndex], fragTexCoord);
+}
\ No newline at end of file
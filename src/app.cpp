@@ -1,4 +1,5 @@
 #include <chrono>
+#include <fstream>
 #include <memory>
 #include <stdexcept>
 
@@ -14,10 +15,13 @@
 #include <systems/movement_system.hpp>
 #include <systems/lsd_system.hpp>
 
-Coordinator gCoordinator(LogLevel::DEBUG);
+Coordinator gCoordinator(LogLevel::DEBUG, LogMode::ASYNC);
 ResourceManager gResourceManager;
 
 App::App() {
+    gCoordinator.OpenBinaryLog(NAME + ".binlog");
+    gCoordinator.OpenFileLog("logs");
+
     mWindow = std::make_shared<Window>(WIDTH, HEIGHT, NAME);
     mDevice = std::make_shared<Device>(mWindow);
     mRenderer = std::make_shared<Renderer>(mWindow, mDevice);
@@ -33,6 +37,10 @@ void App::Run() {
     // load resources
     gResourceManager.LoadResources();
 
+    if (HOT_RELOAD_ENABLED) {
+        gResourceManager.EnableHotReload();
+    }
+
     // init systems
     gCoordinator.RegisterComponent<Transform>();
     gCoordinator.RegisterComponent<Renderable>();
@@ -46,6 +54,14 @@ void App::Run() {
     }
     renderSystem->Init(mDevice, mRenderer->GetSwapChainRenderPass());
 
+    if (HOT_RELOAD_ENABLED) {
+        renderSystem->EnableHotReload();
+    }
+
+    if (RENDER_BENCHMARK) {
+        renderSystem->EnableBenchmark();
+    }
+
     auto movementSystem = gCoordinator.RegisterSystem<MovementSystem>();
     {
         Signature signature;
@@ -59,11 +75,17 @@ void App::Run() {
         signature.set(gCoordinator.GetComponentType<Renderable>());
         gCoordinator.SetSystemSignature<LsdSystem>(signature);
     }
+    lsdSystem->Init();
+
+    gCoordinator.AddListener(METHOD_LISTENER(Events::Memory::Report::ID, App::OnMemoryReport));
+    mMemoryReportTimer = gCoordinator.ScheduleRepeating(MEMORY_REPORT_INTERVAL,
+                                                        MEMORY_REPORT_INTERVAL,
+                                                        Events::Memory::Report::ID);
 
     Entity entity = gCoordinator.CreateEntity();
 
-    Renderable renderable{gResourceManager.GetModel("square"),
-                          gResourceManager.GetTexture("chicken"),
+    Renderable renderable{gResourceManager.FindModel("square"_hash),
+                          gResourceManager.FindTexture("chicken"_hash),
                           glm::vec3(1.0f),
                           1.0f};
 
@@ -87,16 +109,16 @@ void App::Run() {
     while (!mWindow->ShouldClose()) {
         auto startTime = std::chrono::high_resolution_clock::now();
 
+        gCoordinator.UpdateTimers(dt);
+        gResourceManager.Update();
+
         if (auto commandBuffer = mRenderer->BeginFrame()) {
             mRenderer->BeginSwapChainRenderPass(commandBuffer);
 
-            // get frame index
-            int frameIndex = mRenderer->GetFrameIndex();
-
             // render game objects
             lsdSystem->Update(dt);
             movementSystem->Update(dt);
-            renderSystem->Render(commandBuffer, frameIndex);
+            renderSystem->Render(commandBuffer, mRenderer->GetFrameRing());
 
             mRenderer->EndSwapChainRenderPass(commandBuffer);
             mRenderer->EndFrame();
@@ -110,3 +132,36 @@ void App::Run() {
 
     vkDeviceWaitIdle(mDevice->GetDevice());
 }
+
+void App::OnMemoryReport([[maybe_unused]] Event const& event) {
+    MemoryAllocator::Stats stats = mDevice->GetAllocator().GetStats();
+    constexpr VkDeviceSize MiB = 1024 * 1024;
+
+    gCoordinator.LogInfo("memory: ", stats.reservedBytes / MiB, " MiB reserved (peak ",
+                         stats.peakReservedBytes / MiB, "), ", stats.allocationCount, " allocations in ",
+                         stats.deviceAllocationCount, " device allocations");
+
+    for (size_t i = 0; i < stats.categories.size(); i++) {
+        const auto& category = stats.categories[i];
+
+        if (category.peakBytes > 0) {
+            gCoordinator.LogInfo("    ", MemoryCategoryName(static_cast<MemoryCategory>(i)), ": ",
+                                 category.bytes / 1024, " KiB in ", category.allocationCount,
+                                 " allocations (peak ", category.peakBytes / 1024, " KiB)");
+        }
+    }
+
+    if (stats.budgetAvailable) {
+        for (size_t i = 0; i < stats.heaps.size(); i++) {
+            gCoordinator.LogInfo("    heap ", i, ": ", stats.heaps[i].usageBytes / MiB, " of ",
+                                 stats.heaps[i].budgetBytes / MiB, " MiB budget used");
+        }
+    }
+
+    // appended so a soak run leaves the whole history behind
+    std::ofstream file(MEMORY_REPORT_FILE, std::ios::app);
+
+    if (file) {
+        file << "{\"time\":" << gCoordinator.GetTime() << ",\"memory\":" << stats.ToJson() << "}\n";
+    }
+}
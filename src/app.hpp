@@ -4,6 +4,7 @@
 #include <model.hpp>
 #include <renderer.hpp>
 #include "core/window/window.hpp"
+#include "core/coordinator.hpp"
 #include <texture.hpp>
 #include <glm/glm.hpp>
 
@@ -13,12 +14,26 @@
 #include <memory>
 #include <vector>
 
+// set by CMake, see the HOT_RELOAD option
+#ifndef HOT_RELOAD
+#define HOT_RELOAD 0
+#endif
+
 class App {
 
 public:
     static constexpr uint32_t WIDTH = 1280;
     static constexpr uint32_t HEIGHT = 720;
     static constexpr std::string NAME = "Vulkan";
+    // reload textures and shaders when their files change, off unless
+    // configured with -DHOT_RELOAD=ON
+    static constexpr bool HOT_RELOAD_ENABLED = HOT_RELOAD;
+    // cycle through the render paths and log how long each takes to record
+    static constexpr bool RENDER_BENCHMARK = false;
+    // seconds between device memory reports, each is logged and appended
+    // as one JSON line to MEMORY_REPORT_FILE
+    static constexpr float MEMORY_REPORT_INTERVAL = 30.0f;
+    static constexpr const char *MEMORY_REPORT_FILE = "logs/memory_stats.jsonl";
 
     App();
     ~App();
@@ -26,12 +41,14 @@ public:
     void Run();
 
 private:
+    void OnMemoryReport(Event const& event);
 
     std::shared_ptr<Window> mWindow;
     std::shared_ptr<Device> mDevice;
     std::shared_ptr<Renderer> mRenderer;
     std::shared_ptr<Model> mModel;
     std::shared_ptr<Texture> mTex;
+    TimerHandle mMemoryReportTimer;
 
     glm::vec3 color = {0.0f, 0.0f, 0.0f};
     int sign = 1;
@@ -0,0 +1,105 @@
+#include <asset_pack.hpp>
+
+#include "core/io/lz4.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+AssetPack::AssetPack(const std::string& filePath) : mPath(filePath) {
+    int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        throw std::runtime_error("failed to open asset pack: " + filePath);
+    }
+
+    struct stat status;
+
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(PackFormat::FileHeader)) {
+        close(fd);
+        throw std::runtime_error("invalid asset pack: " + filePath);
+    }
+
+    mSize = static_cast<size_t>(status.st_size);
+    void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping keeps the file referenced
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("failed to map asset pack: " + filePath);
+    }
+
+    mData = static_cast<const unsigned char *>(data);
+
+    PackFormat::FileHeader header;
+    std::memcpy(&header, mData, sizeof(header));
+
+    size_t indexEnd = sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(PackFormat::Entry);
+
+    if (header.magic != PackFormat::MAGIC || header.version != PackFormat::VERSION || indexEnd > mSize) {
+        munmap(data, mSize);
+        throw std::runtime_error("invalid asset pack: " + filePath);
+    }
+
+    mEntries = reinterpret_cast<const PackFormat::Entry *>(mData + sizeof(header));
+    mEntryCount = header.entryCount;
+
+    // validate once, lookups and reads trust the index afterwards
+    for (uint32_t i = 0; i < mEntryCount; i++) {
+        const PackFormat::Entry& entry = mEntries[i];
+
+        bool sorted = i == 0 || mEntries[i - 1].id < entry.id;
+        bool inBounds = entry.offset >= indexEnd &&
+                        entry.offset + entry.prefixSize + entry.storedSize <= mSize &&
+                        entry.prefixSize <= entry.size;
+        bool sizesMatch = entry.compression == PackFormat::Compression::LZ4 ||
+                          (entry.compression == PackFormat::Compression::NONE &&
+                           entry.storedSize == entry.size - entry.prefixSize);
+
+        if (!sorted || !inBounds || !sizesMatch) {
+            munmap(data, mSize);
+            throw std::runtime_error("corrupt asset pack index: " + filePath);
+        }
+    }
+}
+
+AssetPack::~AssetPack() {
+    munmap(const_cast<unsigned char *>(mData), mSize);
+}
+
+const PackFormat::Entry *AssetPack::Find(ResourceId id) const {
+    const PackFormat::Entry *end = mEntries + mEntryCount;
+    const PackFormat::Entry *it = std::lower_bound(mEntries, end, id, [](const PackFormat::Entry& entry, ResourceId id) {
+        return entry.id < id;
+    });
+
+    return it != end && it->id == id ? it : nullptr;
+}
+
+void AssetPack::ReadPayload(const PackFormat::Entry& entry, void *dst) const {
+    const unsigned char *payload = mData + entry.offset + entry.prefixSize;
+    size_t size = static_cast<size_t>(entry.size - entry.prefixSize);
+
+    // pages are only touched once, read ahead instead of faulting them in one by one
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(payload) & ~(pageSize - 1);
+    madvise(reinterpret_cast<void *>(start),
+            reinterpret_cast<uintptr_t>(payload) + entry.storedSize - start,
+            MADV_WILLNEED);
+
+    if (entry.compression == PackFormat::Compression::NONE) {
+        std::memcpy(dst, payload, size);
+        return;
+    }
+
+    if (!Lz4::Decompress(payload, static_cast<size_t>(entry.storedSize), dst, size)) {
+        throw std::runtime_error("corrupt entry " + std::to_string(entry.id) + " in asset pack " + mPath);
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <asset_pack_format.hpp>
+#include <resource_handle.hpp>
+
+#include <cstddef>
+#include <string>
+
+// Read only view of a .pack archive. The whole file is mapped once, lookups
+// binary search the sorted index and entry data is copied or decompressed
+// straight from the mapping into the caller's memory, typically staging
+// memory handed out by the UploadManager.
+class AssetPack {
+public:
+    explicit AssetPack(const std::string& filePath);
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // nullptr when the pack has no entry with that id
+    const PackFormat::Entry *Find(ResourceId id) const;
+
+    const void *GetPrefix(const PackFormat::Entry& entry) const {
+        return mData + entry.offset;
+    }
+
+    // Writes the size - prefixSize bytes following the prefix to dst
+    void ReadPayload(const PackFormat::Entry& entry, void *dst) const;
+
+    const std::string& GetPath() const {
+        return mPath;
+    }
+
+private:
+    std::string mPath;
+
+    const unsigned char *mData = nullptr;
+    size_t mSize = 0;
+
+    const PackFormat::Entry *mEntries = nullptr;
+    uint32_t mEntryCount = 0;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of .pack archives written by the AssetPacker tool. A pack is a
+// FileHeader, entryCount Entry records sorted by id, and the entry data,
+// each entry starting on an ENTRY_ALIGNMENT boundary. All fields are little
+// endian.
+//
+// An entry starts with prefixSize bytes stored as is, small metadata such
+// as a cooked texture header that has to be read before the rest can be
+// placed. The remaining size - prefixSize bytes follow, LZ4 compressed
+// into storedSize bytes or uncompressed.
+namespace PackFormat {
+
+constexpr uint32_t MAGIC = 0x50414b56; // "VKAP"
+constexpr uint32_t VERSION = 1;
+
+constexpr uint64_t ENTRY_ALIGNMENT = 64;
+
+constexpr const char *EXTENSION = ".pack";
+
+enum class EntryType : uint32_t {
+    RAW = 0,
+    // a .vkft blob, the prefix holds its header and level table
+    COOKED_TEXTURE = 1
+};
+
+enum class Compression : uint32_t {
+    NONE = 0,
+    LZ4 = 1
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct Entry {
+    // ResourceId of the asset name
+    uint32_t id;
+    EntryType type;
+    Compression compression;
+    uint32_t prefixSize;
+    // from the start of the file
+    uint64_t offset;
+    // bytes stored after the prefix
+    uint64_t storedSize;
+    // bytes of the entry once decompressed, prefix included
+    uint64_t size;
+};
+
+static_assert(sizeof(FileHeader) == 16);
+static_assert(sizeof(Entry) == 40);
+
+}
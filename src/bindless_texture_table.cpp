@@ -0,0 +1,90 @@
+#include <bindless_texture_table.hpp>
+
+// std
+#include <stdexcept>
+
+BindlessTextureTable::BindlessTextureTable(std::shared_ptr<Device> device) : mDevice(device) {
+    // update after bind lets textures be published while earlier frames
+    // still use the set, partially bound lets the unused slots stay empty
+    mSetLayout = DescriptorSetLayout::Builder(mDevice)
+        .AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, CAPACITY)
+        .SetBindingFlags(0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
+        .SetFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
+        .Build();
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = CAPACITY;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+
+    if (vkCreateDescriptorPool(mDevice->GetDevice(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create bindless descriptor pool");
+    }
+
+    VkDescriptorSetLayout setLayout = mSetLayout->GetDescriptorSetLayout();
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = mDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &setLayout;
+
+    if (vkAllocateDescriptorSets(mDevice->GetDevice(), &allocInfo, &mDescriptorSet) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate bindless descriptor set");
+    }
+
+    // handed out lowest first
+    for (uint32_t slot = CAPACITY; slot > CAPACITY - SPARE_SLOTS; slot--) {
+        mFreeSpareSlots.push_back(slot - 1);
+    }
+}
+
+BindlessTextureTable::~BindlessTextureTable() {
+    vkDestroyDescriptorPool(mDevice->GetDevice(), mDescriptorPool, nullptr);
+}
+
+bool BindlessTextureTable::Write(TextureHandle handle, const Texture &texture) {
+    if (handle.index >= CAPACITY - SPARE_SLOTS) {
+        return false;
+    }
+
+    Write(handle.index, texture);
+    return true;
+}
+
+void BindlessTextureTable::Write(uint32_t slot, const Texture &texture) {
+    VkDescriptorImageInfo imageInfo = texture.DescriptorInfo();
+
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = mDescriptorSet;
+    write.dstBinding = 0;
+    write.dstArrayElement = slot;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.descriptorCount = 1;
+    write.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(mDevice->GetDevice(), 1, &write, 0, nullptr);
+}
+
+std::optional<uint32_t> BindlessTextureTable::AcquireSpareSlot() {
+    if (mFreeSpareSlots.empty()) {
+        return std::nullopt;
+    }
+
+    uint32_t slot = mFreeSpareSlots.back();
+    mFreeSpareSlots.pop_back();
+    return slot;
+}
+
+void BindlessTextureTable::ReleaseSpareSlot(uint32_t slot) {
+    mFreeSpareSlots.push_back(slot);
+}
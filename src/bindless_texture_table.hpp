@@ -0,0 +1,53 @@
+#pragma once
+
+#include <device.hpp>
+#include <descriptors.hpp>
+#include <texture.hpp>
+
+// std
+#include <memory>
+#include <optional>
+#include <vector>
+
+// One descriptor set holding every loaded texture in a single array of
+// combined image samplers. Slot i holds the texture whose handle has index
+// i, so shaders select a texture with TextureHandle::index and nothing is
+// bound per draw. Slots are written only when a texture is published; a
+// slot is overwritten only after the texture in it was released, which
+// never happens while frames can still sample it.
+//
+// The last SPARE_SLOTS slots are not tied to handles. A texture replaced in
+// place (hot reload) moves to a spare slot, since its own slot is still
+// sampled by frames in flight.
+class BindlessTextureTable {
+public:
+    static constexpr uint32_t CAPACITY = Device::BINDLESS_TEXTURE_COUNT;
+    static constexpr uint32_t SPARE_SLOTS = 256;
+
+    BindlessTextureTable(std::shared_ptr<Device> device);
+    ~BindlessTextureTable();
+
+    BindlessTextureTable(const BindlessTextureTable &) = delete;
+    BindlessTextureTable &operator=(const BindlessTextureTable &) = delete;
+
+    // False if the handle index lies past the slots tied to handles, the
+    // texture then has no slot in the table
+    bool Write(TextureHandle handle, const Texture &texture);
+    void Write(uint32_t slot, const Texture &texture);
+
+    // std::nullopt once every spare slot is taken
+    std::optional<uint32_t> AcquireSpareSlot();
+    void ReleaseSpareSlot(uint32_t slot);
+
+    VkDescriptorSetLayout GetDescriptorSetLayout() const { return mSetLayout->GetDescriptorSetLayout(); }
+    VkDescriptorSet GetDescriptorSet() const { return mDescriptorSet; }
+
+private:
+    std::shared_ptr<Device> mDevice;
+
+    std::unique_ptr<DescriptorSetLayout> mSetLayout;
+    VkDescriptorPool mDescriptorPool;
+    VkDescriptorSet mDescriptorSet;
+
+    std::vector<uint32_t> mFreeSpareSlots;
+};
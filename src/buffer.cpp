@@ -33,7 +33,9 @@ Buffer::Buffer(
     uint32_t instanceCount,
     VkBufferUsageFlags usageFlags,
     VkMemoryPropertyFlags memoryPropertyFlags,
-    VkDeviceSize minOffsetAlignment)
+    VkDeviceSize minOffsetAlignment,
+    bool sharedWithTransfer,
+    MemoryCategory category)
     : mDevice{device},
       mInstanceSize{instanceSize},
       mInstanceCount{instanceCount},
@@ -41,39 +43,45 @@ Buffer::Buffer(
       mMemoryPropertyFlags{memoryPropertyFlags} {
   mAlignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
   mBufferSize = mAlignmentSize * instanceCount;
-  device->CreateBuffer(mBufferSize, usageFlags, memoryPropertyFlags, mBuffer, mMemory);
+  device->CreateBuffer(mBufferSize, usageFlags, memoryPropertyFlags, mBuffer, mMemory, sharedWithTransfer, category);
 }
 
 Buffer::~Buffer() {
   Unmap();
   vkDestroyBuffer(mDevice->GetDevice(), mBuffer, nullptr);
-  vkFreeMemory(mDevice->GetDevice(), mMemory, nullptr);
+  mDevice->GetAllocator().Free(mMemory);
 }
 
 /**
  * Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
  *
+ * @note Host visible memory is mapped by the allocator for its whole lifetime, buffers sharing a
+ * block cannot map it themselves. Mapping only hands out a pointer into it.
+ *
  * @param size (Optional) Size of the memory range to map. Pass VK_WHOLE_SIZE to map the complete
  * buffer range.
  * @param offset (Optional) Byte offset from beginning
  *
  * @return VkResult of the buffer mapping call
  */
-VkResult Buffer::Map(VkDeviceSize size, VkDeviceSize offset) {
-  assert(mBuffer && mMemory && "Called map on buffer before create");
-  return vkMapMemory(mDevice->GetDevice(), mMemory, offset, size, 0, &mpMapped);
+VkResult Buffer::Map([[maybe_unused]] VkDeviceSize size, VkDeviceSize offset) {
+  assert(mBuffer && mMemory.memory && "Called map on buffer before create");
+
+  if (!mMemory.mapped) {
+    return VK_ERROR_MEMORY_MAP_FAILED;
+  }
+
+  mpMapped = static_cast<char *>(mMemory.mapped) + offset;
+  return VK_SUCCESS;
 }
 
 /**
  * Unmap a mapped memory range
  *
- * @note Does not return a result as vkUnmapMemory can't fail
+ * @note Does not return a result, the memory itself stays mapped by the allocator
  */
 void Buffer::Unmap() {
-  if (mpMapped) {
-    vkUnmapMemory(mDevice->GetDevice(), mMemory);
-    mpMapped = nullptr;
-  }
+  mpMapped = nullptr;
 }
 
 /**
@@ -111,9 +119,9 @@ void Buffer::WriteToBuffer(void *data, VkDeviceSize size, VkDeviceSize offset) {
 VkResult Buffer::Flush(VkDeviceSize size, VkDeviceSize offset) {
   VkMappedMemoryRange mappedRange = {};
   mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-  mappedRange.memory = mMemory;
-  mappedRange.offset = offset;
-  mappedRange.size = size;
+  mappedRange.memory = mMemory.memory;
+  mappedRange.offset = mMemory.offset + offset;
+  mappedRange.size = size == VK_WHOLE_SIZE ? mMemory.size - offset : size;
   return vkFlushMappedMemoryRanges(mDevice->GetDevice(), 1, &mappedRange);
 }
 
@@ -131,9 +139,9 @@ VkResult Buffer::Flush(VkDeviceSize size, VkDeviceSize offset) {
 VkResult Buffer::Invalidate(VkDeviceSize size, VkDeviceSize offset) {
   VkMappedMemoryRange mappedRange = {};
   mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-  mappedRange.memory = mMemory;
-  mappedRange.offset = offset;
-  mappedRange.size = size;
+  mappedRange.memory = mMemory.memory;
+  mappedRange.offset = mMemory.offset + offset;
+  mappedRange.size = size == VK_WHOLE_SIZE ? mMemory.size - offset : size;
   return vkInvalidateMappedMemoryRanges(mDevice->GetDevice(), 1, &mappedRange);
 }
 
@@ -12,7 +12,9 @@ class Buffer {
       uint32_t instanceCount,
       VkBufferUsageFlags usageFlags,
       VkMemoryPropertyFlags memoryPropertyFlags,
-      VkDeviceSize minOffsetAlignment = 1);
+      VkDeviceSize minOffsetAlignment = 1,
+      bool sharedWithTransfer = false,
+      MemoryCategory category = MemoryCategory::OTHER);
   ~Buffer();
  
   Buffer(const Buffer&) = delete;
@@ -46,7 +48,7 @@ class Buffer {
   std::shared_ptr<Device> mDevice;
   void* mpMapped = nullptr;
   VkBuffer mBuffer = VK_NULL_HANDLE;
-  VkDeviceMemory mMemory = VK_NULL_HANDLE;
+  MemoryAllocator::Allocation mMemory;
  
   VkDeviceSize mBufferSize;
   uint32_t mInstanceCount;
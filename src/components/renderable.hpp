@@ -1,12 +1,18 @@
 #pragma once
 
-#include <memory>
-#include <texture.hpp>
-#include <model.hpp>
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
 
+#include <resource_handle.hpp>
+#include <texture_atlas.hpp>
+
+// Keeps the model and texture it draws referenced, see ResourceRef
 struct Renderable {
-    Model *model;
-    Texture *texture;
+    ModelRef model;
+    TextureRef texture;
     glm::vec3 color;
     float opacity;
+    // when valid, drawn from its atlas page instead of texture
+    SpriteHandle sprite{};
 };
\ No newline at end of file
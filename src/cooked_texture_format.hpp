@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of .vkft files written by the TextureCooker tool. A file is a
+// FileHeader, levelCount LevelEntry records and the pixel data of every
+// level, tightly packed in the image format and ready to be copied into
+// staging memory as is. All fields are little endian.
+namespace CookedTexture {
+
+constexpr uint32_t MAGIC = 0x54464b56; // "VKFT"
+constexpr uint32_t VERSION = 1;
+
+// VkFormat values, kept here so the cooker does not depend on Vulkan
+constexpr uint32_t FORMAT_R8G8B8A8_SRGB = 43;
+
+constexpr const char *EXTENSION = ".vkft";
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    // size of the pixel data following the level table
+    uint64_t dataSize;
+};
+
+struct LevelEntry {
+    // relative to the start of the pixel data
+    uint64_t offset;
+    uint32_t width;
+    uint32_t height;
+};
+
+static_assert(sizeof(FileHeader) == 32);
+static_assert(sizeof(LevelEntry) == 16);
+
+}
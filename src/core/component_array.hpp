@@ -3,6 +3,7 @@
 #include <array>
 #include <cassert>
 #include <unordered_map>
+#include <utility>
 
 #include "core/types.hpp"
 
@@ -28,7 +29,7 @@ public:
 		size_t newIndex = mSize;
 		mEntityToIndexMap[entity] = newIndex;
 		mIndexToEntityMap[newIndex] = entity;
-		mComponentArray[newIndex] = component;
+		mComponentArray[newIndex] = std::move(component);
 		++mSize;
 	}
 
@@ -37,10 +38,13 @@ public:
 		assert(mEntityToIndexMap.find(entity) != mEntityToIndexMap.end()
             && "Removing non-existent component.");
 
-		// Copy element at end into deleted element's place to maintain density
+		// Move element at end into deleted element's place to maintain density
 		size_t indexOfRemovedEntity = mEntityToIndexMap[entity];
 		size_t indexOfLastElement = mSize - 1;
-		mComponentArray[indexOfRemovedEntity] = mComponentArray[indexOfLastElement];
+		mComponentArray[indexOfRemovedEntity] = std::move(mComponentArray[indexOfLastElement]);
+
+		// Reset the vacated slot, so components owning resources release them now
+		mComponentArray[indexOfLastElement] = T{};
 
 		// Update map to point to moved spot
 		Entity entityOfLastElement = mIndexToEntityMap[indexOfLastElement];
@@ -73,6 +77,6 @@ private:
 	std::array<T, MAX_ENTITIES> mComponentArray;
 	std::unordered_map<Entity, size_t> mEntityToIndexMap;
 	std::unordered_map<size_t, Entity> mIndexToEntityMap;
-	size_t mSize;
+	size_t mSize{};
 };
 
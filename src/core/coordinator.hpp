@@ -12,8 +12,8 @@
 class Coordinator
 {
 public:
-    Coordinator(LogLevel logLevel)
-        : mLogManager(std::make_unique<LogManager>(logLevel)),
+    Coordinator(LogLevel logLevel, LogMode logMode = LogMode::SYNC)
+        : mLogManager(std::make_unique<LogManager>(logLevel, logMode)),
           mEventManager(std::make_unique<EventManager>()),
           mEntityManager(std::make_unique<EntityManager>()),
           mComponentManager(std::make_unique<ComponentManager>()),
@@ -36,6 +36,39 @@ public:
         mEventManager.get()->SendEvent(id);
     }
 
+    TimerHandle ScheduleAt(float time, EventId id = Events::Timer::ID, std::uint64_t userData = 0) const
+    {
+        return mEventManager->ScheduleAt(time, id, userData);
+    }
+
+    TimerHandle ScheduleAfter(float delay, EventId id = Events::Timer::ID, std::uint64_t userData = 0) const
+    {
+        return mEventManager->ScheduleAfter(delay, id, userData);
+    }
+
+    TimerHandle ScheduleRepeating(float delay,
+                                  float interval,
+                                  EventId id = Events::Timer::ID,
+                                  std::uint64_t userData = 0) const
+    {
+        return mEventManager->ScheduleRepeating(delay, interval, id, userData);
+    }
+
+    bool CancelTimer(TimerHandle handle) const
+    {
+        return mEventManager->CancelTimer(handle);
+    }
+
+    void UpdateTimers(float dt) const
+    {
+        mEventManager->UpdateTimers(dt);
+    }
+
+    float GetTime() const
+    {
+        return mEventManager->GetTime();
+    }
+
     // EntityManager Methods
     Entity CreateEntity() const
     {
@@ -124,12 +157,38 @@ public:
         mLogManager->Error(args...);
     }
 
+    template <typename... Args>
+    void LogBinary(LogSite& site, Args const&... args) const
+    {
+        mLogManager->Binary(site, args...);
+    }
+
+    void OpenBinaryLog(const std::string& filePath) const
+    {
+        mLogManager->OpenBinaryLog(filePath);
+    }
+
+    void OpenFileLog(const std::string& directory) const
+    {
+        mLogManager->OpenFileLog(directory);
+    }
+
+    void SetLogSubsystem(std::string_view subsystem) const
+    {
+        LogManager::SetSubsystem(subsystem);
+    }
+
     template<typename T, typename... Args>
     void Assert(T condition, Args&&... args) const
     {
         mLogManager->Assert(condition, args...);
     }
 
+    void FlushLog() const
+    {
+        mLogManager->Flush();
+    }
+
 private:
     const std::unique_ptr<LogManager> mLogManager;
     const std::unique_ptr<EventManager> mEventManager;
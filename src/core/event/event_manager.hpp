@@ -3,9 +3,11 @@
 #include <unordered_map>
 #include <functional>
 #include <list>
+#include <vector>
 
 #include "core/event/event_types.hpp"
 #include "core/event/event.hpp"
+#include "core/event/timer_wheel.hpp"
 
 
 class EventManager
@@ -34,7 +36,57 @@ public:
         }
     }
 
+    TimerHandle ScheduleAt(float time, EventId id, std::uint64_t userData)
+    {
+        return mTimerWheel.ScheduleAt(time, id, userData);
+    }
+
+    TimerHandle ScheduleAfter(float delay, EventId id, std::uint64_t userData)
+    {
+        return mTimerWheel.ScheduleAfter(delay, id, userData);
+    }
+
+    TimerHandle ScheduleRepeating(float delay, float interval, EventId id, std::uint64_t userData)
+    {
+        return mTimerWheel.ScheduleRepeating(delay, interval, id, userData);
+    }
+
+    bool CancelTimer(TimerHandle handle)
+    {
+        return mTimerWheel.Cancel(handle);
+    }
+
+    float GetTime() const
+    {
+        return mTimerWheel.GetTime();
+    }
+
+    // Advances the timer wheel and sends one event per event id carrying
+    // every timer of that id that expired during this update.
+    void UpdateTimers(float dt)
+    {
+        std::size_t expiredCount = mTimerWheel.Advance(dt, [this](EventId id, TimerExpiration const& expiration) {
+            mExpiredTimers[id].push_back(expiration);
+        });
+
+        if (expiredCount == 0) {
+            return;
+        }
+
+        for (auto& [id, batch] : mExpiredTimers) {
+            if (batch.empty()) {
+                continue;
+            }
+
+            SendEvent(Event(id).SetParam(Events::Timer::EXPIRED, batch));
+            batch.clear();
+        }
+    }
+
 private:
     std::unordered_map<EventId, std::list<std::function<void(Event const&)>>> mListeners;
+
+    TimerWheel mTimerWheel;
+    std::unordered_map<EventId, std::vector<TimerExpiration>> mExpiredTimers;
 };
 
@@ -42,6 +42,16 @@ EVENT_PARAM_DEFINE(Input::Async::Key, ACTION)
 EVENT_PARAM_DEFINE(Input::Async::Key, MODS)
 EVENT_DEFINE_END
 
+EVENT_DEFINE_START(Timer)
+EVENT_PARAM_DEFINE(Timer, EXPIRED)
+EVENT_DEFINE_END
+
+EVENT_DEFINE_START(Lsd::Transition)
+EVENT_DEFINE_END
+
+EVENT_DEFINE_START(Memory::Report)
+EVENT_DEFINE_END
+
 EVENT_DEFINE_START(Input::Sync::Key)
 EVENT_PARAM_DEFINE(Input::Sync::Key, KEYS)
 EVENT_DEFINE_END
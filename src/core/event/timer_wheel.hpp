@@ -0,0 +1,358 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "core/event/event_types.hpp"
+
+
+struct TimerHandle
+{
+    std::uint32_t index = std::numeric_limits<std::uint32_t>::max();
+    std::uint32_t generation = 0;
+
+    bool IsValid() const
+    {
+        return index != std::numeric_limits<std::uint32_t>::max();
+    }
+
+    bool operator==(TimerHandle const& other) const = default;
+};
+
+struct TimerExpiration
+{
+    TimerHandle handle;
+    std::uint64_t userData;
+};
+
+
+// Hierarchical timer wheel (Varghese & Lauck). Timers are kept in intrusive
+// lists hanging off LEVEL_COUNT wheels of SLOT_COUNT slots each, so scheduling
+// and cancelling are O(1). Advancing skips empty slots using per-level
+// occupancy bitmaps and only touches timers that expire or cascade down a
+// level, so a large number of pending timers costs nothing while idle.
+class TimerWheel
+{
+public:
+    explicit TimerWheel(float tickDuration = 0.001f)
+        : mTickDuration(tickDuration)
+    {
+        assert(tickDuration > 0.0f && "Timer tick duration must be positive.");
+
+        for (auto& level : mSlots) {
+            level.fill(INVALID_INDEX);
+        }
+    }
+
+    TimerHandle ScheduleAt(float time, EventId eventId, std::uint64_t userData = 0)
+    {
+        return Insert(ToTicks(time), 0, eventId, userData);
+    }
+
+    TimerHandle ScheduleAfter(float delay, EventId eventId, std::uint64_t userData = 0)
+    {
+        return Insert(mCurrentTick + ToTicks(delay), 0, eventId, userData);
+    }
+
+    TimerHandle ScheduleRepeating(float delay, float interval, EventId eventId, std::uint64_t userData = 0)
+    {
+        std::uint64_t intervalTicks = ToTicks(interval);
+
+        return Insert(mCurrentTick + ToTicks(delay),
+                      intervalTicks > 0 ? intervalTicks : 1,
+                      eventId,
+                      userData);
+    }
+
+    bool Cancel(TimerHandle handle)
+    {
+        if (!IsPending(handle)) {
+            return false;
+        }
+
+        Unlink(handle.index);
+        Release(handle.index);
+        return true;
+    }
+
+    bool IsPending(TimerHandle handle) const
+    {
+        return handle.index < mTimers.size()
+            && mTimers[handle.index].generation == handle.generation
+            && mTimers[handle.index].active;
+    }
+
+    // Advances the wheel by dt seconds and reports every expired timer to
+    // onExpired(eventId, expiration). Repeating timers are re-armed before the
+    // callback returns, so the callback must not schedule or cancel timers.
+    // Returns the number of expirations.
+    template<typename Callback>
+    std::size_t Advance(float dt, Callback&& onExpired)
+    {
+        mTime += dt;
+
+        std::uint64_t target = ToTicks(mTime);
+        std::size_t expiredCount = 0;
+
+        while (mCurrentTick < target) {
+            std::uint64_t next = NextInterestingTick(target);
+            mCurrentTick = next;
+
+            if ((mCurrentTick & SLOT_MASK) == 0) {
+                Cascade();
+            }
+
+            expiredCount += ExpireSlot(mCurrentTick & SLOT_MASK, onExpired);
+        }
+
+        return expiredCount;
+    }
+
+    float GetTime() const
+    {
+        return static_cast<float>(mTime);
+    }
+
+    std::size_t GetPendingCount() const
+    {
+        return mPendingCount;
+    }
+
+private:
+    static constexpr std::uint32_t SLOT_BITS = 8;
+    static constexpr std::uint32_t SLOT_COUNT = 1u << SLOT_BITS;
+    static constexpr std::uint64_t SLOT_MASK = SLOT_COUNT - 1;
+    static constexpr std::uint32_t LEVEL_COUNT = 4;
+    static constexpr std::uint64_t MAX_DELTA = (1ull << (SLOT_BITS * LEVEL_COUNT)) - 1;
+    static constexpr std::uint32_t INVALID_INDEX = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::uint32_t BITMAP_WORDS = SLOT_COUNT / 64;
+
+    struct Timer
+    {
+        std::uint64_t expiry;
+        std::uint64_t interval;
+        std::uint64_t userData;
+        EventId eventId;
+        std::uint32_t generation;
+        std::uint32_t prev;
+        std::uint32_t next;
+        std::uint8_t level;
+        std::uint8_t slot;
+        bool active;
+    };
+
+    std::uint64_t ToTicks(double time) const
+    {
+        if (time <= 0.0) {
+            return 0;
+        }
+
+        return static_cast<std::uint64_t>(std::llround(time / mTickDuration));
+    }
+
+    TimerHandle Insert(std::uint64_t expiry, std::uint64_t interval, EventId eventId, std::uint64_t userData)
+    {
+        std::uint32_t index;
+
+        if (mFreeList != INVALID_INDEX) {
+            index = mFreeList;
+            mFreeList = mTimers[index].next;
+        } else {
+            index = static_cast<std::uint32_t>(mTimers.size());
+            mTimers.push_back(Timer{});
+        }
+
+        Timer& timer = mTimers[index];
+        timer.expiry = expiry > mCurrentTick ? expiry : mCurrentTick + 1;
+        timer.interval = interval;
+        timer.userData = userData;
+        timer.eventId = eventId;
+        timer.active = true;
+
+        Link(index);
+        ++mPendingCount;
+
+        return {index, timer.generation};
+    }
+
+    void Release(std::uint32_t index)
+    {
+        Timer& timer = mTimers[index];
+        timer.active = false;
+        ++timer.generation;
+        timer.next = mFreeList;
+        mFreeList = index;
+        --mPendingCount;
+    }
+
+    // Places a timer in the level whose span covers its distance from now.
+    // Timers further away than the outermost wheel are clamped and re-linked
+    // when they reach the bottom.
+    void Link(std::uint32_t index)
+    {
+        Timer& timer = mTimers[index];
+
+        assert(timer.expiry >= mCurrentTick && "Linking timer that is already overdue.");
+
+        std::uint64_t expiry = timer.expiry;
+        std::uint64_t delta = expiry - mCurrentTick;
+
+        if (delta > MAX_DELTA) {
+            expiry = mCurrentTick + MAX_DELTA;
+            delta = MAX_DELTA;
+        }
+
+        std::uint32_t level = 0;
+        while (level + 1 < LEVEL_COUNT && delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+
+        std::uint32_t slot = static_cast<std::uint32_t>((expiry >> (SLOT_BITS * level)) & SLOT_MASK);
+
+        timer.level = static_cast<std::uint8_t>(level);
+        timer.slot = static_cast<std::uint8_t>(slot);
+        timer.prev = INVALID_INDEX;
+        timer.next = mSlots[level][slot];
+
+        if (timer.next != INVALID_INDEX) {
+            mTimers[timer.next].prev = index;
+        }
+
+        mSlots[level][slot] = index;
+        mOccupied[level][slot / 64] |= 1ull << (slot % 64);
+    }
+
+    void Unlink(std::uint32_t index)
+    {
+        Timer& timer = mTimers[index];
+
+        if (timer.prev != INVALID_INDEX) {
+            mTimers[timer.prev].next = timer.next;
+        } else {
+            mSlots[timer.level][timer.slot] = timer.next;
+        }
+
+        if (timer.next != INVALID_INDEX) {
+            mTimers[timer.next].prev = timer.prev;
+        }
+
+        if (mSlots[timer.level][timer.slot] == INVALID_INDEX) {
+            mOccupied[timer.level][timer.slot / 64] &= ~(1ull << (timer.slot % 64));
+        }
+    }
+
+    std::uint32_t DetachSlot(std::uint32_t level, std::uint32_t slot)
+    {
+        std::uint32_t head = mSlots[level][slot];
+
+        mSlots[level][slot] = INVALID_INDEX;
+        mOccupied[level][slot / 64] &= ~(1ull << (slot % 64));
+
+        return head;
+    }
+
+    // Returns the first occupied slot in [from, SLOT_COUNT) of a level, or
+    // SLOT_COUNT if there is none.
+    std::uint32_t FindOccupied(std::uint32_t level, std::uint32_t from) const
+    {
+        for (std::uint32_t word = from / 64; word < BITMAP_WORDS; ++word) {
+            std::uint64_t bits = mOccupied[level][word];
+
+            if (word == from / 64) {
+                bits &= ~0ull << (from % 64);
+            }
+
+            if (bits) {
+                return word * 64 + static_cast<std::uint32_t>(std::countr_zero(bits));
+            }
+        }
+
+        return SLOT_COUNT;
+    }
+
+    // Next tick that either holds level 0 timers or crosses a level 0
+    // revolution (where higher levels cascade), capped at target.
+    std::uint64_t NextInterestingTick(std::uint64_t target) const
+    {
+        std::uint32_t from = static_cast<std::uint32_t>((mCurrentTick & SLOT_MASK) + 1);
+        std::uint64_t revolutionStart = mCurrentTick & ~SLOT_MASK;
+        std::uint64_t next = revolutionStart + SLOT_COUNT;
+
+        if (from < SLOT_COUNT) {
+            std::uint32_t slot = FindOccupied(0, from);
+
+            if (slot < SLOT_COUNT) {
+                next = revolutionStart + slot;
+            }
+        }
+
+        return next < target ? next : target;
+    }
+
+    // Moves the timers of every level whose index just wrapped one level
+    // closer to expiry.
+    void Cascade()
+    {
+        for (std::uint32_t level = 1; level < LEVEL_COUNT; ++level) {
+            std::uint32_t slot = static_cast<std::uint32_t>((mCurrentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+            std::uint32_t index = DetachSlot(level, slot);
+
+            while (index != INVALID_INDEX) {
+                std::uint32_t next = mTimers[index].next;
+                Link(index);
+                index = next;
+            }
+
+            if (slot != 0) {
+                break;
+            }
+        }
+    }
+
+    template<typename Callback>
+    std::size_t ExpireSlot(std::uint32_t slot, Callback& onExpired)
+    {
+        std::size_t expiredCount = 0;
+        std::uint32_t index = DetachSlot(0, static_cast<std::uint32_t>(slot));
+
+        while (index != INVALID_INDEX) {
+            Timer& timer = mTimers[index];
+            std::uint32_t next = timer.next;
+
+            if (timer.expiry > mCurrentTick) {
+                // clamped long-range timer, not due yet
+                Link(index);
+            } else {
+                onExpired(timer.eventId, TimerExpiration{{index, timer.generation}, timer.userData});
+                ++expiredCount;
+
+                if (timer.interval > 0) {
+                    timer.expiry += timer.interval;
+                    Link(index);
+                } else {
+                    Release(index);
+                }
+            }
+
+            index = next;
+        }
+
+        return expiredCount;
+    }
+
+    const double mTickDuration;
+    double mTime = 0.0;
+    std::uint64_t mCurrentTick = 0;
+    std::size_t mPendingCount = 0;
+
+    std::vector<Timer> mTimers;
+    std::uint32_t mFreeList = INVALID_INDEX;
+
+    std::array<std::array<std::uint32_t, SLOT_COUNT>, LEVEL_COUNT> mSlots;
+    std::array<std::array<std::uint64_t, BITMAP_WORDS>, LEVEL_COUNT> mOccupied{};
+};
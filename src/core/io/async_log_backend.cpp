@@ -0,0 +1,336 @@
+#include "core/io/async_log_backend.hpp"
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+// posix
+#include <unistd.h>
+
+
+std::atomic<AsyncLogBackend*> AsyncLogBackend::sInstance{nullptr};
+
+namespace {
+
+constexpr std::size_t RECORD_ALIGNMENT = 8;
+
+// how long a crashing thread waits for a Drain on another thread to finish
+constexpr std::chrono::milliseconds SIGNAL_DRAIN_WAIT{100};
+
+constexpr std::size_t AlignRecord(std::size_t size)
+{
+    return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+}
+
+AsyncLogBackend::AsyncLogBackend()
+{
+    mWriter = std::thread(&AsyncLogBackend::Run, this);
+}
+
+AsyncLogBackend::~AsyncLogBackend()
+{
+    AsyncLogBackend* self = this;
+    sInstance.compare_exchange_strong(self, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mRunning = false;
+    }
+    mWake.notify_one();
+
+    if (mWriter.joinable()) {
+        mWriter.join();
+    }
+
+    Flush();
+}
+
+AsyncLogBackend::ThreadRing::~ThreadRing()
+{
+    if (ring) {
+        ring->retired.store(true, std::memory_order_release);
+    }
+}
+
+AsyncLogBackend::Ring* AsyncLogBackend::GetThreadRing()
+{
+    thread_local ThreadRing threadRing;
+
+    if (threadRing.owner == this) {
+        return threadRing.ring.get();
+    }
+
+    std::lock_guard<std::mutex> lock(mRegistryMutex);
+
+    for (std::size_t i = 0; i < MAX_PRODUCERS; ++i) {
+        if (mOwnedRings[i]) {
+            continue;
+        }
+
+        auto ring = std::make_shared<Ring>();
+        mOwnedRings[i] = ring;
+        mRings[i].store(ring.get(), std::memory_order_release);
+
+        threadRing.ring = std::move(ring);
+        threadRing.owner = this;
+
+        return threadRing.ring.get();
+    }
+
+    return nullptr;
+}
+
+bool AsyncLogBackend::Push(int fd, std::string_view record, bool blocking)
+{
+    Ring* ring = GetThreadRing();
+
+    if (!ring) {
+        // more producer threads than rings, write through
+        WriteAll(fd, record.data(), record.size());
+        return true;
+    }
+
+    std::size_t payloadSize = std::min(record.size(), RING_CAPACITY / 2);
+    std::size_t recordSize = AlignRecord(sizeof(RecordHeader) + payloadSize);
+
+    std::size_t head = ring->head.load(std::memory_order_relaxed);
+
+    while (RING_CAPACITY - (head - ring->tail.load(std::memory_order_acquire)) < recordSize) {
+        if (!blocking) {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (!mRunning) {
+            // writer thread already stopped during shutdown
+            Drain();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mWakeRequested = true;
+        }
+        mWake.notify_one();
+        std::this_thread::yield();
+    }
+
+    RecordHeader header{static_cast<std::uint32_t>(payloadSize), fd};
+    CopyIn(*ring, head, &header, sizeof(header));
+    CopyIn(*ring, head + sizeof(header), record.data(), payloadSize);
+
+    ring->head.store(head + recordSize, std::memory_order_release);
+
+    // wake the writer early instead of waiting for the next interval when
+    // the ring is filling up
+    if (head + recordSize - ring->tail.load(std::memory_order_relaxed) > RING_CAPACITY / 2) {
+        {
+            std::lock_guard<std::mutex> lock(mWakeMutex);
+            mWakeRequested = true;
+        }
+        mWake.notify_one();
+    }
+
+    return true;
+}
+
+void AsyncLogBackend::Flush()
+{
+    Drain();
+}
+
+void AsyncLogBackend::Run()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait_for(lock, FLUSH_INTERVAL, [this]() {
+                return mWakeRequested || !mRunning;
+            });
+
+            mWakeRequested = false;
+
+            if (!mRunning) {
+                break;
+            }
+        }
+
+        Drain();
+    }
+}
+
+void AsyncLogBackend::Drain()
+{
+    std::lock_guard<std::mutex> lock(mDrainMutex);
+
+    // only contended by DrainFromSignal, which never gives it back before
+    // the process dies
+    while (mDraining.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    for (std::size_t i = 0; i < MAX_PRODUCERS; ++i) {
+        Ring* ring = mRings[i].load(std::memory_order_acquire);
+
+        if (!ring) {
+            continue;
+        }
+
+        // read the flag before the head so a retired ring is fully drained
+        bool retired = ring->retired.load(std::memory_order_acquire);
+        std::size_t head = ring->head.load(std::memory_order_acquire);
+        std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+
+        while (tail < head) {
+            RecordHeader header;
+            CopyOut(*ring, tail, &header, sizeof(header));
+
+            std::string& batch = mBatches[header.fd];
+            std::size_t offset = batch.size();
+            batch.resize(offset + header.size);
+            CopyOut(*ring, tail + sizeof(header), batch.data() + offset, header.size);
+
+            tail += AlignRecord(sizeof(header) + header.size);
+        }
+
+        ring->tail.store(tail, std::memory_order_release);
+
+        if (retired) {
+            std::lock_guard<std::mutex> registryLock(mRegistryMutex);
+            mRings[i].store(nullptr, std::memory_order_release);
+            mOwnedRings[i].reset();
+        }
+    }
+
+    std::uint64_t dropped = mDropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        mBatches[STDERR_FILENO] += "[ERROR]\tlog backend dropped " + std::to_string(dropped) + " records\n";
+    }
+
+    for (auto& [fd, batch] : mBatches) {
+        if (!batch.empty()) {
+            WriteAll(fd, batch.data(), batch.size());
+            batch.clear();
+        }
+    }
+
+    mDraining.store(false, std::memory_order_release);
+}
+
+// Runs inside a signal handler: no locks and no allocation, records are
+// written straight out of the rings.
+void AsyncLogBackend::DrainFromSignal()
+{
+    // a Drain on another thread writes what it has taken out of the rings
+    // and hands over. One interrupted on this thread never finishes, its
+    // records are left unwritten rather than written twice
+    auto deadline = std::chrono::steady_clock::now() + SIGNAL_DRAIN_WAIT;
+
+    while (mDraining.exchange(true, std::memory_order_acquire)) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return;
+        }
+    }
+    for (std::size_t i = 0; i < MAX_PRODUCERS; ++i) {
+        Ring* ring = mRings[i].load(std::memory_order_acquire);
+
+        if (!ring) {
+            continue;
+        }
+
+        std::size_t head = ring->head.load(std::memory_order_acquire);
+        std::size_t tail = ring->tail.load(std::memory_order_acquire);
+
+        while (tail < head) {
+            RecordHeader header;
+            CopyOut(*ring, tail, &header, sizeof(header));
+
+            std::size_t position = (tail + sizeof(header)) % RING_CAPACITY;
+            std::size_t firstPart = std::min<std::size_t>(header.size, RING_CAPACITY - position);
+
+            WriteAll(header.fd, ring->data + position, firstPart);
+            WriteAll(header.fd, ring->data, header.size - firstPart);
+
+            tail += AlignRecord(sizeof(header) + header.size);
+        }
+
+        ring->tail.store(tail, std::memory_order_release);
+    }
+
+    mDraining.store(false, std::memory_order_release);
+}
+
+void AsyncLogBackend::InstallCrashHandlers()
+{
+    AsyncLogBackend* expected = nullptr;
+    if (!sInstance.compare_exchange_strong(expected, this)) {
+        return;
+    }
+
+    for (int signal : {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGTERM, SIGINT}) {
+        struct sigaction action{};
+        action.sa_handler = SignalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESETHAND;
+        sigaction(signal, &action, nullptr);
+    }
+
+    std::atexit(FlushAtExit);
+}
+
+void AsyncLogBackend::SignalHandler(int signal)
+{
+    if (AsyncLogBackend* backend = sInstance.exchange(nullptr)) {
+        backend->DrainFromSignal();
+    }
+
+    // SA_RESETHAND restored the default disposition
+    raise(signal);
+}
+
+void AsyncLogBackend::FlushAtExit()
+{
+    if (AsyncLogBackend* backend = sInstance.load()) {
+        backend->Flush();
+    }
+}
+
+void AsyncLogBackend::CopyIn(Ring& ring, std::size_t position, const void* src, std::size_t size)
+{
+    position %= RING_CAPACITY;
+    std::size_t firstPart = std::min(size, RING_CAPACITY - position);
+
+    std::memcpy(ring.data + position, src, firstPart);
+    std::memcpy(ring.data, static_cast<const char*>(src) + firstPart, size - firstPart);
+}
+
+void AsyncLogBackend::CopyOut(const Ring& ring, std::size_t position, void* dst, std::size_t size)
+{
+    position %= RING_CAPACITY;
+    std::size_t firstPart = std::min(size, RING_CAPACITY - position);
+
+    std::memcpy(dst, ring.data + position, firstPart);
+    std::memcpy(static_cast<char*>(dst) + firstPart, ring.data, size - firstPart);
+}
+
+void AsyncLogBackend::WriteAll(int fd, const char* data, std::size_t size)
+{
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
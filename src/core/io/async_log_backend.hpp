@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+
+// Background log writer. Every producer thread owns a single-producer /
+// single-consumer byte ring, so logging from a hot path is a memcpy and two
+// atomic stores. A writer thread drains all rings periodically and hands each
+// output file descriptor a single write() per batch.
+class AsyncLogBackend
+{
+public:
+    static constexpr std::size_t RING_CAPACITY = 256 * 1024;
+    static constexpr std::size_t MAX_PRODUCERS = 64;
+    static constexpr std::chrono::milliseconds FLUSH_INTERVAL{5};
+
+    AsyncLogBackend();
+    ~AsyncLogBackend();
+
+    AsyncLogBackend(const AsyncLogBackend&) = delete;
+    AsyncLogBackend& operator=(const AsyncLogBackend&) = delete;
+
+    // Queues a preformatted record for fd. Non-blocking pushes drop the
+    // record when the calling thread's ring is full; blocking pushes wait for
+    // the writer to make room. Returns false if the record was dropped.
+    bool Push(int fd, std::string_view record, bool blocking);
+
+    // Synchronously writes everything queued so far.
+    void Flush();
+
+    // Installs handlers that drain the rings on fatal signals before
+    // re-raising them, plus an atexit hook.
+    void InstallCrashHandlers();
+
+private:
+    struct Ring
+    {
+        alignas(64) std::atomic<std::size_t> head{0};
+        alignas(64) std::atomic<std::size_t> tail{0};
+        std::atomic<bool> retired{false};
+        char data[RING_CAPACITY];
+    };
+
+    struct RecordHeader
+    {
+        std::uint32_t size;
+        std::int32_t fd;
+    };
+
+    struct ThreadRing
+    {
+        std::shared_ptr<Ring> ring;
+        const AsyncLogBackend* owner = nullptr;
+
+        ~ThreadRing();
+    };
+
+    Ring* GetThreadRing();
+    void Run();
+    void Drain();
+    void DrainFromSignal();
+
+    static void CopyIn(Ring& ring, std::size_t position, const void* src, std::size_t size);
+    static void CopyOut(const Ring& ring, std::size_t position, void* dst, std::size_t size);
+    static void WriteAll(int fd, const char* data, std::size_t size);
+    static void SignalHandler(int signal);
+    static void FlushAtExit();
+
+    static std::atomic<AsyncLogBackend*> sInstance;
+
+    std::array<std::atomic<Ring*>, MAX_PRODUCERS> mRings{};
+    std::array<std::shared_ptr<Ring>, MAX_PRODUCERS> mOwnedRings;
+    std::mutex mRegistryMutex;
+
+    std::mutex mDrainMutex;
+    // held by whoever reads the rings, the signal path cannot take the mutex
+    std::atomic<bool> mDraining{false};
+    std::unordered_map<int, std::string> mBatches;
+
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    bool mWakeRequested = false;
+
+    std::atomic<std::uint64_t> mDropped{0};
+    std::atomic<bool> mRunning{true};
+    std::thread mWriter;
+};
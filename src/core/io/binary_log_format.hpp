@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+
+// On-disk layout shared by BinaryLogger and the offline LogDecoder tool.
+// A log file is a FileHeader followed by a stream of records, each starting
+// with a RecordHeader. FORMAT records describe a call site once; MESSAGE
+// records only carry the site id, a timestamp, the thread and the raw
+// argument bytes. Records from different threads may interleave, so a format
+// record is not guaranteed to precede the messages that use it.
+namespace BinaryLog {
+
+constexpr std::uint32_t MAGIC = 0x4c464b56; // "VKFL"
+constexpr std::uint32_t VERSION = 1;
+
+enum class RecordType : std::uint8_t
+{
+    FORMAT = 1,
+    MESSAGE = 2,
+};
+
+enum class ArgType : std::uint8_t
+{
+    BOOL = 0,
+    CHAR,
+    INT64,
+    UINT64,
+    DOUBLE,
+    STRING,
+};
+
+struct FileHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+};
+
+struct RecordHeader
+{
+    std::uint32_t size; // including this header
+    RecordType type;
+    std::uint8_t reserved[3];
+};
+
+// followed by argCount ArgTypes, the file name and the format string, both
+// null terminated
+struct FormatRecord
+{
+    std::uint32_t siteId;
+    std::uint32_t line;
+    std::uint8_t level;
+    std::uint8_t argCount;
+    std::uint8_t reserved[2];
+};
+
+// followed by the arguments: 1 byte for BOOL/CHAR, 8 bytes for numbers and
+// a 32 bit length plus the bytes for STRING
+struct MessageRecord
+{
+    std::uint32_t siteId;
+    std::uint32_t threadId;
+    std::uint64_t timestamp; // nanoseconds since the unix epoch
+};
+
+template<typename T>
+constexpr ArgType ArgTypeOf()
+{
+    using U = std::remove_cvref_t<T>;
+
+    if constexpr (std::is_same_v<U, bool>) {
+        return ArgType::BOOL;
+    } else if constexpr (std::is_same_v<U, char>) {
+        return ArgType::CHAR;
+    } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        return ArgType::INT64;
+    } else if constexpr (std::is_integral_v<U> || std::is_enum_v<U>) {
+        return ArgType::UINT64;
+    } else if constexpr (std::is_floating_point_v<U>) {
+        return ArgType::DOUBLE;
+    } else {
+        static_assert(std::is_convertible_v<U, std::string_view>,
+                      "Binary log arguments must be numbers, chars, bools or strings");
+        return ArgType::STRING;
+    }
+}
+
+template<typename Tuple>
+struct ArgTypes;
+
+template<typename... Args>
+struct ArgTypes<std::tuple<Args...>>
+{
+    static constexpr std::array<ArgType, sizeof...(Args)> value{ArgTypeOf<Args>()...};
+};
+
+constexpr std::size_t CountPlaceholders(std::string_view format)
+{
+    std::size_t count = 0;
+
+    for (std::size_t i = 0; i + 1 < format.size(); ++i) {
+        if (format[i] == '{' && format[i + 1] == '}') {
+            ++count;
+            ++i;
+        }
+    }
+
+    return count;
+}
+
+}
@@ -0,0 +1,99 @@
+#include "core/io/binary_logger.hpp"
+
+// std
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+// posix
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+BinaryLogger::~BinaryLogger()
+{
+    if (mBackend) {
+        mBackend->Flush();
+    }
+
+    if (mFd >= 0) {
+        close(mFd);
+    }
+}
+
+void BinaryLogger::Open(const std::string& filePath)
+{
+    assert(mFd < 0 && "Binary log is already open.");
+
+    mFd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+
+    if (mFd < 0) {
+        throw std::runtime_error("failed to open binary log: " + filePath);
+    }
+
+    BinaryLog::FileHeader header{BinaryLog::MAGIC, BinaryLog::VERSION};
+    if (write(mFd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+        throw std::runtime_error("failed to write binary log header: " + filePath);
+    }
+}
+
+std::uint32_t BinaryLogger::Register(LogSite& site)
+{
+    std::lock_guard<std::mutex> lock(mRegisterMutex);
+
+    // another thread may have registered the site while we waited
+    std::uint32_t id = site.id.load(std::memory_order_acquire);
+    if (id != 0) {
+        return id;
+    }
+
+    id = mNextSiteId++;
+
+    std::string_view file(site.file);
+    std::string_view format(site.format);
+
+    std::size_t size = sizeof(BinaryLog::RecordHeader) + sizeof(BinaryLog::FormatRecord)
+                     + site.argCount + file.size() + 1 + format.size() + 1;
+
+    std::vector<char> record(size);
+    BinaryLog::RecordHeader header{static_cast<std::uint32_t>(size), BinaryLog::RecordType::FORMAT, {}};
+    BinaryLog::FormatRecord formatRecord{id, site.line, static_cast<std::uint8_t>(site.level), site.argCount, {}};
+
+    char* out = record.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    std::memcpy(out, &formatRecord, sizeof(formatRecord));
+    out += sizeof(formatRecord);
+    std::memcpy(out, site.argTypes, site.argCount);
+    out += site.argCount;
+    std::memcpy(out, file.data(), file.size());
+    out += file.size() + 1;
+    std::memcpy(out, format.data(), format.size());
+
+    Emit(std::string_view(record.data(), record.size()), true);
+
+    site.id.store(id, std::memory_order_release);
+    return id;
+}
+
+void BinaryLogger::Emit(std::string_view record, bool blocking)
+{
+    if (mFd < 0) {
+        return;
+    }
+
+    if (mBackend) {
+        mBackend->Push(mFd, record, blocking);
+        return;
+    }
+
+    // O_APPEND keeps whole records from interleaving
+    [[maybe_unused]] ssize_t written = write(mFd, record.data(), record.size());
+}
+
+std::uint32_t BinaryLogger::ThreadId()
+{
+    thread_local std::uint32_t threadId = static_cast<std::uint32_t>(syscall(SYS_gettid));
+    return threadId;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "core/io/async_log_backend.hpp"
+#include "core/io/binary_log_format.hpp"
+#include "core/io/log_level.hpp"
+
+
+// Most verbose level that is compiled in. Calls above it are discarded at
+// compile time together with their arguments.
+#ifndef BINLOG_LEVEL
+#ifdef NDEBUG
+#define BINLOG_LEVEL 1
+#else
+#define BINLOG_LEVEL 2
+#endif
+#endif
+
+// Describes one logging call site. Instances are constant initialized, the
+// id is assigned the first time the site fires.
+struct LogSite
+{
+    LogLevel level;
+    const char* file;
+    std::uint32_t line;
+    const char* format;
+    const BinaryLog::ArgType* argTypes;
+    std::uint8_t argCount;
+    std::atomic<std::uint32_t> id{0};
+};
+
+#define BINLOG(logLevel, logFormat, ...) \
+    do { \
+        if constexpr (static_cast<int>(logLevel) <= BINLOG_LEVEL) { \
+            using BinlogArgs = decltype(std::make_tuple(__VA_ARGS__)); \
+            static_assert(BinaryLog::CountPlaceholders(logFormat) == std::tuple_size_v<BinlogArgs>, \
+                          "Binary log placeholder count does not match argument count"); \
+            static constinit LogSite binlogSite{ \
+                logLevel, \
+                __FILE__, \
+                __LINE__, \
+                logFormat, \
+                BinaryLog::ArgTypes<BinlogArgs>::value.data(), \
+                static_cast<std::uint8_t>(std::tuple_size_v<BinlogArgs>)}; \
+            gCoordinator.LogBinary(binlogSite __VA_OPT__(,) __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define BINLOG_DEBUG(logFormat, ...) BINLOG(LogLevel::DEBUG, logFormat __VA_OPT__(,) __VA_ARGS__)
+#define BINLOG_INFO(logFormat, ...) BINLOG(LogLevel::NORMAL, logFormat __VA_OPT__(,) __VA_ARGS__)
+#define BINLOG_ERROR(logFormat, ...) BINLOG(LogLevel::CRITICAL, logFormat __VA_OPT__(,) __VA_ARGS__)
+
+
+// Writes deferred-formatting log records. The producer only copies the raw
+// arguments, formatting happens offline in the LogDecoder tool.
+class BinaryLogger
+{
+public:
+    static constexpr std::size_t MAX_RECORD_SIZE = 1024;
+
+    explicit BinaryLogger(AsyncLogBackend* backend)
+        : mBackend(backend)
+    {}
+
+    ~BinaryLogger();
+
+    BinaryLogger(const BinaryLogger&) = delete;
+    BinaryLogger& operator=(const BinaryLogger&) = delete;
+
+    void Open(const std::string& filePath);
+
+    bool IsOpen() const
+    {
+        return mFd >= 0;
+    }
+
+    template<typename... Args>
+    void Write(LogSite& site, Args const&... args)
+    {
+        std::uint32_t id = site.id.load(std::memory_order_acquire);
+
+        if (id == 0) {
+            id = Register(site);
+        }
+
+        thread_local std::array<char, MAX_RECORD_SIZE> record;
+        std::size_t size = sizeof(BinaryLog::RecordHeader) + sizeof(BinaryLog::MessageRecord);
+
+        (Append(record, size, args), ...);
+
+        BinaryLog::RecordHeader header{static_cast<std::uint32_t>(size), BinaryLog::RecordType::MESSAGE, {}};
+        BinaryLog::MessageRecord message{
+            id,
+            ThreadId(),
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count())};
+
+        std::memcpy(record.data(), &header, sizeof(header));
+        std::memcpy(record.data() + sizeof(header), &message, sizeof(message));
+
+        Emit(std::string_view(record.data(), size), site.level == LogLevel::CRITICAL);
+    }
+
+private:
+    template<typename T>
+    static void Append(std::array<char, MAX_RECORD_SIZE>& record, std::size_t& size, T const& arg)
+    {
+        constexpr BinaryLog::ArgType type = BinaryLog::ArgTypeOf<T>();
+
+        if constexpr (type == BinaryLog::ArgType::BOOL || type == BinaryLog::ArgType::CHAR) {
+            if (size + 1 <= MAX_RECORD_SIZE) {
+                record[size++] = static_cast<char>(arg);
+            }
+        } else if constexpr (type == BinaryLog::ArgType::STRING) {
+            std::string_view text(arg);
+
+            if (size + sizeof(std::uint32_t) <= MAX_RECORD_SIZE) {
+                // long strings are truncated to what fits in the record
+                std::uint32_t length = static_cast<std::uint32_t>(
+                    std::min(text.size(), MAX_RECORD_SIZE - size - sizeof(std::uint32_t)));
+
+                std::memcpy(record.data() + size, &length, sizeof(length));
+                std::memcpy(record.data() + size + sizeof(length), text.data(), length);
+                size += sizeof(length) + length;
+            }
+        } else {
+            using Stored = std::conditional_t<type == BinaryLog::ArgType::DOUBLE, double,
+                           std::conditional_t<type == BinaryLog::ArgType::INT64, std::int64_t, std::uint64_t>>;
+            Stored value = static_cast<Stored>(arg);
+
+            if (size + sizeof(value) <= MAX_RECORD_SIZE) {
+                std::memcpy(record.data() + size, &value, sizeof(value));
+                size += sizeof(value);
+            }
+        }
+    }
+
+    std::uint32_t Register(LogSite& site);
+    void Emit(std::string_view record, bool blocking);
+    static std::uint32_t ThreadId();
+
+    AsyncLogBackend* mBackend;
+    int mFd = -1;
+
+    std::mutex mRegisterMutex;
+    std::uint32_t mNextSiteId = 1;
+};
@@ -0,0 +1,123 @@
+#include "core/io/file_watcher.hpp"
+
+// std
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+
+// posix
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+
+FileWatcher::FileWatcher()
+{
+    mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    mStopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (mInotifyFd < 0 || mStopFd < 0) {
+        if (mInotifyFd >= 0) {
+            close(mInotifyFd);
+        }
+        if (mStopFd >= 0) {
+            close(mStopFd);
+        }
+
+        throw std::runtime_error("failed to create file watcher");
+    }
+
+    mThread = std::thread(&FileWatcher::Run, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+    mRunning.store(false, std::memory_order_release);
+
+    std::uint64_t value = 1;
+    [[maybe_unused]] ssize_t written = write(mStopFd, &value, sizeof(value));
+
+    if (mThread.joinable()) {
+        mThread.join();
+    }
+
+    close(mInotifyFd);
+    close(mStopFd);
+}
+
+bool FileWatcher::Watch(const std::string& directory)
+{
+    int wd = inotify_add_watch(mInotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+    if (wd < 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mDirectoriesMutex);
+    mDirectories[wd] = directory;
+    return true;
+}
+
+std::vector<std::string> FileWatcher::TakeChanges()
+{
+    std::lock_guard<std::mutex> lock(mChangesMutex);
+
+    std::vector<std::string> changes(mChanges.begin(), mChanges.end());
+    mChanges.clear();
+    return changes;
+}
+
+void FileWatcher::Run()
+{
+    pollfd fds[2] = {
+        {mInotifyFd, POLLIN, 0},
+        {mStopFd, POLLIN, 0},
+    };
+
+    while (mRunning.load(std::memory_order_acquire)) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            return;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ReadEvents();
+        }
+    }
+}
+
+void FileWatcher::ReadEvents()
+{
+    alignas(inotify_event) char buffer[4096];
+
+    while (true) {
+        ssize_t length = read(mInotifyFd, buffer, sizeof(buffer));
+
+        if (length <= 0) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> directoriesLock(mDirectoriesMutex);
+        std::lock_guard<std::mutex> changesLock(mChangesMutex);
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            auto directory = mDirectories.find(event->wd);
+
+            if (event->len == 0 || directory == mDirectories.end()) {
+                continue;
+            }
+
+            mChanges.insert(directory->second + "/" + event->name);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+// Watches directories for files that were rewritten, using inotify on a
+// background thread. Only finished writes are reported (close after write
+// and renames into the directory), so editors saving through a temporary
+// file show up as a single change of the final path. Changes accumulate
+// until the owner collects them, typically once per frame.
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Not recursive. Returns false if the directory cannot be watched
+    bool Watch(const std::string& directory);
+
+    // Paths changed since the last call, each reported once
+    std::vector<std::string> TakeChanges();
+
+private:
+    void Run();
+    void ReadEvents();
+
+    int mInotifyFd = -1;
+    // written to wake the watcher thread for shutdown
+    int mStopFd = -1;
+
+    std::mutex mDirectoriesMutex;
+    std::unordered_map<int, std::string> mDirectories;
+
+    std::mutex mChangesMutex;
+    std::unordered_set<std::string> mChanges;
+
+    std::atomic<bool> mRunning{true};
+    std::thread mThread;
+};
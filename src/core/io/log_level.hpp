@@ -0,0 +1,17 @@
+#pragma once
+
+
+enum class LogLevel
+{
+    CRITICAL = 0,
+    NORMAL,
+    DEBUG,
+};
+
+enum class LogMode
+{
+    // write and flush on the calling thread
+    SYNC = 0,
+    // format on the calling thread, write on a background thread
+    ASYNC,
+};
@@ -2,20 +2,64 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <utility>
 
+#include <unistd.h>
+
+#include "core/io/async_log_backend.hpp"
+#include "core/io/binary_logger.hpp"
+#include "core/io/log_level.hpp"
+#include "core/io/mapped_log_sink.hpp"
 
-enum class LogLevel
-{
-    CRITICAL = 0,
-    NORMAL,
-    DEBUG,
-};
 
 class LogManager
 {
 public:
-    LogManager(LogLevel logLevel): mLogLevel(logLevel) {}
+    LogManager(LogLevel logLevel, LogMode logMode = LogMode::SYNC)
+        : mLogLevel(logLevel)
+    {
+        if (logMode == LogMode::ASYNC) {
+            mAsyncBackend = std::make_unique<AsyncLogBackend>();
+            mAsyncBackend->InstallCrashHandlers();
+        }
+
+        mBinaryLogger = std::make_unique<BinaryLogger>(mAsyncBackend.get());
+    }
+
+    // Enables the BINLOG_* macros, records are written to filePath and can
+    // be rendered with the LogDecoder tool.
+    void OpenBinaryLog(const std::string& filePath)
+    {
+        mBinaryLogger->Open(filePath);
+    }
+
+    // Additionally keeps every printed record in memory-mapped segment files
+    // under directory, which survive a crash of the process.
+    void OpenFileLog(const std::string& directory,
+                     std::size_t segmentSize = 4 * 1024 * 1024,
+                     std::uint32_t segmentCount = 4)
+    {
+        mFileSink = std::make_unique<MappedLogSink>(directory, "engine", segmentSize, segmentCount);
+    }
+
+    // Tags the records printed by the calling thread in the file log.
+    static void SetSubsystem(std::string_view subsystem)
+    {
+        Subsystem() = subsystem;
+    }
+
+    template <typename... Args>
+    void Binary(LogSite& site, Args const&... args)
+    {
+        if (site.level <= mLogLevel && mBinaryLogger->IsOpen())
+        {
+            mBinaryLogger->Write(site, args...);
+        }
+    }
 
     template <typename... Args>
     void Debug(Args&&... args)
@@ -42,13 +86,33 @@ public:
         if (!condition)
         {
             Error(args...);
+            Flush();
             exit(EXIT_FAILURE);
         }
 #endif
     }
 
+    void Flush()
+    {
+        if (mAsyncBackend) {
+            mAsyncBackend->Flush();
+        } else {
+            std::cout.flush();
+            std::cerr.flush();
+        }
+    }
+
 private:
     LogLevel mLogLevel;
+    std::unique_ptr<AsyncLogBackend> mAsyncBackend;
+    std::unique_ptr<BinaryLogger> mBinaryLogger;
+    std::unique_ptr<MappedLogSink> mFileSink;
+
+    static std::string& Subsystem()
+    {
+        thread_local std::string subsystem = "engine";
+        return subsystem;
+    }
 
     template <typename Arg, typename... Args>
     void Print(std::ostream& os,
@@ -59,10 +123,41 @@ private:
     {
         if (logLevel <= mLogLevel)
         {
+            if (mAsyncBackend || mFileSink)
+            {
+                thread_local std::ostringstream record;
+
+                // format once, the sinks share the message text
+                record.str("");
+                record << "[" << type << "]\t";
+                std::size_t messageStart = record.view().size();
+                record << std::forward<Arg>(arg);
+                ((record << std::forward<Args>(args)), ...);
+
+                if (mFileSink)
+                {
+                    mFileSink->Write(logLevel, Subsystem(), record.view().substr(messageStart));
+                }
+
+                record << '\n';
+
+                if (mAsyncBackend)
+                {
+                    // errors are never dropped, the caller waits for room instead
+                    mAsyncBackend->Push(&os == &std::cerr ? STDERR_FILENO : STDOUT_FILENO,
+                                        record.view(),
+                                        logLevel == LogLevel::CRITICAL);
+                }
+                else
+                {
+                    os << record.view() << std::flush;
+                }
+                return;
+            }
+
             os << "[" << type << "]\t" << std::forward<Arg>(arg);
             ((os << std::forward<Args>(args)), ...);
             os << std::endl;
         }
     }
 };
-
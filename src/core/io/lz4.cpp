@@ -0,0 +1,219 @@
+#include "core/io/lz4.hpp"
+
+// std
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+namespace {
+
+constexpr std::size_t MIN_MATCH = 4;
+// the format requires the last 5 bytes to be literals and the last match
+// to start at least 12 bytes before the end of the block
+constexpr std::size_t LAST_LITERALS = 5;
+constexpr std::size_t MATCH_FIND_LIMIT = 12;
+constexpr std::size_t MAX_OFFSET = 65535;
+constexpr unsigned HASH_BITS = 16;
+
+std::uint32_t Read32(const std::uint8_t* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t Hash(std::uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+std::uint8_t* WriteLength(std::uint8_t* out, std::size_t length)
+{
+    for (; length >= 255; length -= 255) {
+        *out++ = 255;
+    }
+
+    *out++ = static_cast<std::uint8_t>(length);
+    return out;
+}
+
+std::uint8_t* WriteSequence(std::uint8_t* out,
+                            const std::uint8_t* literals,
+                            std::size_t literalLength,
+                            std::size_t offset,
+                            std::size_t matchLength)
+{
+    std::size_t matchCode = matchLength - MIN_MATCH;
+    std::uint8_t* token = out++;
+
+    *token = static_cast<std::uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+    if (literalLength >= 15) {
+        out = WriteLength(out, literalLength - 15);
+    }
+
+    std::memcpy(out, literals, literalLength);
+    out += literalLength;
+
+    // the final sequence carries literals only
+    if (matchLength == 0) {
+        return out;
+    }
+
+    *out++ = static_cast<std::uint8_t>(offset);
+    *out++ = static_cast<std::uint8_t>(offset >> 8);
+
+    *token |= static_cast<std::uint8_t>(matchCode < 15 ? matchCode : 15);
+    if (matchCode >= 15) {
+        out = WriteLength(out, matchCode - 15);
+    }
+
+    return out;
+}
+
+bool ReadLength(const std::uint8_t*& in, const std::uint8_t* end, std::size_t& length)
+{
+    std::uint8_t byte;
+
+    do {
+        if (in == end) {
+            return false;
+        }
+
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+}
+
+namespace Lz4 {
+
+std::size_t CompressBound(std::size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+std::size_t Compress(const void* src, std::size_t srcSize, void* dst)
+{
+    const auto* in = static_cast<const std::uint8_t*>(src);
+    auto* out = static_cast<std::uint8_t*>(dst);
+
+    std::size_t anchor = 0;
+
+    if (srcSize > MATCH_FIND_LIMIT) {
+        // positions are stored plus one, zero marks an empty slot
+        std::vector<std::uint32_t> table(std::size_t(1) << HASH_BITS, 0);
+
+        std::size_t matchEnd = srcSize - LAST_LITERALS;
+        std::size_t position = 0;
+
+        while (position <= srcSize - MATCH_FIND_LIMIT) {
+            std::uint32_t sequence = Read32(in + position);
+            std::uint32_t& slot = table[Hash(sequence)];
+            std::size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(position + 1);
+
+            if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET ||
+                Read32(in + candidate - 1) != sequence) {
+                ++position;
+                continue;
+            }
+
+            std::size_t match = candidate - 1;
+
+            while (position > anchor && match > 0 && in[position - 1] == in[match - 1]) {
+                --position;
+                --match;
+            }
+
+            std::size_t length = MIN_MATCH;
+            while (position + length < matchEnd && in[position + length] == in[match + length]) {
+                ++length;
+            }
+
+            out = WriteSequence(out, in + anchor, position - anchor, position - match, length);
+
+            position += length;
+            anchor = position;
+        }
+    }
+
+    out = WriteSequence(out, in + anchor, srcSize - anchor, 0, 0);
+    return static_cast<std::size_t>(out - static_cast<std::uint8_t*>(dst));
+}
+
+bool Decompress(const void* src, std::size_t srcSize, void* dst, std::size_t dstSize)
+{
+    const auto* in = static_cast<const std::uint8_t*>(src);
+    const auto* inEnd = in + srcSize;
+    auto* outBegin = static_cast<std::uint8_t*>(dst);
+    auto* out = outBegin;
+    auto* outEnd = out + dstSize;
+
+    while (true) {
+        if (in == inEnd) {
+            return false;
+        }
+
+        std::uint8_t token = *in++;
+
+        std::size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(in, inEnd, literalLength)) {
+            return false;
+        }
+
+        if (literalLength > static_cast<std::size_t>(inEnd - in) ||
+            literalLength > static_cast<std::size_t>(outEnd - out)) {
+            return false;
+        }
+
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        // the block ends after the literals of its last sequence
+        if (in == inEnd) {
+            break;
+        }
+
+        if (inEnd - in < 2) {
+            return false;
+        }
+
+        std::size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+
+        if (offset == 0 || offset > static_cast<std::size_t>(out - outBegin)) {
+            return false;
+        }
+
+        std::size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(in, inEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+
+        if (matchLength > static_cast<std::size_t>(outEnd - out)) {
+            return false;
+        }
+
+        const std::uint8_t* match = out - offset;
+
+        if (offset >= matchLength) {
+            std::memcpy(out, match, matchLength);
+            out += matchLength;
+        } else {
+            // overlapping copy repeats the last offset bytes
+            for (std::size_t i = 0; i < matchLength; ++i) {
+                *out++ = match[i];
+            }
+        }
+    }
+
+    return out == outEnd;
+}
+
+}
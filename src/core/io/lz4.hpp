@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+
+// Self-contained codec for the LZ4 block format. Compression is the simple
+// greedy single-probe variant, good enough for offline packing; the decoder
+// validates every length and offset, so corrupt input fails instead of
+// reading or writing out of bounds.
+namespace Lz4 {
+
+// Largest possible compressed size of size bytes
+std::size_t CompressBound(std::size_t size);
+
+// Returns the compressed size, dst must hold CompressBound(srcSize) bytes
+std::size_t Compress(const void* src, std::size_t srcSize, void* dst);
+
+// Decompresses a whole block, succeeds only if it expands to exactly dstSize bytes
+bool Decompress(const void* src, std::size_t srcSize, void* dst, std::size_t dstSize);
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+
+// On-disk layout of the memory-mapped log segments written by
+// MappedLogSink. Each segment file starts with a SegmentHeader followed by
+// 8 byte aligned records. A record is valid only if its commit word matches
+// the segment sequence, which is written last, so a reader recovering after a
+// crash stops at the first record that was never completed.
+namespace MappedLog {
+
+constexpr std::uint32_t MAGIC = 0x53464b56; // "VKFS"
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint32_t RECORD_ALIGNMENT = 8;
+constexpr std::uint32_t SUBSYSTEM_LENGTH = 16;
+
+struct SegmentHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t sequence;
+    std::uint64_t size;
+    std::uint64_t reserved;
+};
+
+// followed by messageLength bytes of text
+struct RecordHeader
+{
+    std::uint32_t size; // including this header and padding
+    std::uint32_t commit;
+    std::uint64_t timestamp; // nanoseconds since the unix epoch
+    std::uint32_t threadId;
+    std::uint16_t messageLength;
+    std::uint8_t level;
+    std::uint8_t reserved;
+    char subsystem[SUBSYSTEM_LENGTH];
+};
+
+constexpr std::uint32_t CommitWord(std::uint64_t sequence)
+{
+    // scrambled so zero-filled space does not look like a committed record
+    return static_cast<std::uint32_t>(sequence) ^ 0xa5a5a5a5u;
+}
+
+}
@@ -0,0 +1,170 @@
+#include "core/io/mapped_log_sink.hpp"
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+// posix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace {
+
+std::size_t AlignRecord(std::size_t size)
+{
+    return (size + MappedLog::RECORD_ALIGNMENT - 1) & ~static_cast<std::size_t>(MappedLog::RECORD_ALIGNMENT - 1);
+}
+
+std::uint32_t ThreadId()
+{
+    thread_local std::uint32_t threadId = static_cast<std::uint32_t>(syscall(SYS_gettid));
+    return threadId;
+}
+
+}
+
+MappedLogSink::MappedLogSink(const std::string& directory,
+                             const std::string& name,
+                             std::size_t segmentSize,
+                             std::uint32_t segmentCount)
+    : mSegmentSize(segmentSize),
+      mSegments(segmentCount)
+{
+    if (segmentCount < 2) {
+        throw std::invalid_argument("mapped log needs at least two segments");
+    }
+
+    if (segmentSize < sizeof(MappedLog::SegmentHeader) +
+                      AlignRecord(sizeof(MappedLog::RecordHeader) + MAX_MESSAGE_LENGTH)) {
+        throw std::invalid_argument("mapped log segment size is too small for a record");
+    }
+
+    std::filesystem::create_directories(directory);
+
+    // continue after the newest segment of a previous run so its most
+    // recent records survive until the ring wraps around
+    std::uint32_t newestSegment = segmentCount - 1;
+    std::uint64_t newestSequence = 0;
+
+    for (std::uint32_t i = 0; i < segmentCount; ++i) {
+        OpenSegment(i, SegmentPath(directory, name, i));
+
+        auto* header = reinterpret_cast<MappedLog::SegmentHeader*>(mSegments[i].data);
+        if (header->magic == MappedLog::MAGIC && header->sequence > newestSequence) {
+            newestSequence = header->sequence;
+            newestSegment = i;
+        }
+    }
+
+    mNextSequence = newestSequence + 1;
+    mCurrentSegment.store(newestSegment);
+    Rotate(newestSegment);
+}
+
+MappedLogSink::~MappedLogSink()
+{
+    for (auto& segment : mSegments) {
+        if (segment.data) {
+            munmap(segment.data, mSegmentSize);
+        }
+    }
+}
+
+std::string MappedLogSink::SegmentPath(const std::string& directory, const std::string& name, std::uint32_t index)
+{
+    return (std::filesystem::path(directory) / (name + "." + std::to_string(index) + ".seg")).string();
+}
+
+void MappedLogSink::OpenSegment(std::uint32_t index, const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        throw std::runtime_error("failed to open log segment: " + path);
+    }
+
+    // reserve the blocks up front so a full disk cannot fault a write later
+    int result = posix_fallocate(fd, 0, static_cast<off_t>(mSegmentSize));
+    if (result != 0) {
+        close(fd);
+        throw std::runtime_error("failed to preallocate log segment: " + path + ": " + std::strerror(result));
+    }
+
+    void* data = mmap(nullptr, mSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("failed to map log segment: " + path);
+    }
+
+    mSegments[index].data = static_cast<char*>(data);
+}
+
+void MappedLogSink::Rotate(std::uint32_t fullSegment)
+{
+    std::lock_guard<std::mutex> lock(mRotateMutex);
+
+    // another writer already rotated away from this segment
+    if (mCurrentSegment.load(std::memory_order_acquire) != fullSegment) {
+        return;
+    }
+
+    std::uint32_t nextSegment = (fullSegment + 1) % static_cast<std::uint32_t>(mSegments.size());
+    Segment& segment = mSegments[nextSegment];
+
+    std::uint64_t sequence = mNextSequence++;
+    segment.sequence.store(sequence, std::memory_order_relaxed);
+
+    MappedLog::SegmentHeader header{MappedLog::MAGIC, MappedLog::VERSION, sequence, mSegmentSize, 0};
+    std::memcpy(segment.data, &header, sizeof(header));
+
+    segment.writeOffset.store(sizeof(header), std::memory_order_relaxed);
+    mCurrentSegment.store(nextSegment, std::memory_order_release);
+}
+
+void MappedLogSink::Write(LogLevel level, std::string_view subsystem, std::string_view message)
+{
+    std::size_t messageLength = std::min(message.size(), MAX_MESSAGE_LENGTH);
+    std::size_t size = AlignRecord(sizeof(MappedLog::RecordHeader) + messageLength);
+
+    while (true) {
+        std::uint32_t index = mCurrentSegment.load(std::memory_order_acquire);
+        Segment& segment = mSegments[index];
+
+        // a writer stalled across a full wrap of the ring commits with the
+        // old sequence, so its record is ignored instead of read as new
+        std::uint64_t sequence = segment.sequence.load(std::memory_order_relaxed);
+        std::size_t offset = segment.writeOffset.fetch_add(size, std::memory_order_relaxed);
+
+        if (offset + size > mSegmentSize) {
+            Rotate(index);
+            continue;
+        }
+
+        auto* record = reinterpret_cast<MappedLog::RecordHeader*>(segment.data + offset);
+
+        record->size = static_cast<std::uint32_t>(size);
+        record->timestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        record->threadId = ThreadId();
+        record->messageLength = static_cast<std::uint16_t>(messageLength);
+        record->level = static_cast<std::uint8_t>(level);
+        record->reserved = 0;
+
+        std::memset(record->subsystem, 0, sizeof(record->subsystem));
+        std::memcpy(record->subsystem, subsystem.data(), std::min(subsystem.size(), sizeof(record->subsystem)));
+        std::memcpy(segment.data + offset + sizeof(MappedLog::RecordHeader), message.data(), messageLength);
+
+        // publish the record last so recovery never sees a torn one
+        std::atomic_ref<std::uint32_t>(record->commit)
+            .store(MappedLog::CommitWord(sequence), std::memory_order_release);
+        return;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/io/log_level.hpp"
+#include "core/io/mapped_log_format.hpp"
+
+
+// Persistent log sink writing structured records into a fixed set of
+// preallocated, memory-mapped segment files. Writers reserve space with an
+// atomic add and copy the record into the mapping, so logging never issues a
+// syscall; the kernel writes the pages back, which also keeps them when the
+// process crashes. When a segment fills up the sink rotates to the oldest
+// one, so the newest segmentCount segments of records are always kept.
+class MappedLogSink
+{
+public:
+    static constexpr std::size_t MAX_MESSAGE_LENGTH = 4096;
+
+    MappedLogSink(const std::string& directory,
+                  const std::string& name,
+                  std::size_t segmentSize,
+                  std::uint32_t segmentCount);
+    ~MappedLogSink();
+
+    MappedLogSink(const MappedLogSink&) = delete;
+    MappedLogSink& operator=(const MappedLogSink&) = delete;
+
+    void Write(LogLevel level, std::string_view subsystem, std::string_view message);
+
+    static std::string SegmentPath(const std::string& directory, const std::string& name, std::uint32_t index);
+
+private:
+    struct Segment
+    {
+        char* data = nullptr;
+        std::atomic<std::size_t> writeOffset{0};
+        std::atomic<std::uint64_t> sequence{0};
+    };
+
+    void OpenSegment(std::uint32_t index, const std::string& path);
+    void Rotate(std::uint32_t fullSegment);
+
+    const std::size_t mSegmentSize;
+    std::vector<Segment> mSegments;
+    std::atomic<std::uint32_t> mCurrentSegment{0};
+
+    std::mutex mRotateMutex;
+    std::uint64_t mNextSequence = 1;
+};
@@ -0,0 +1,110 @@
+#include "core/io/xxhash.hpp"
+
+// std
+#include <cstring>
+
+
+namespace {
+
+constexpr std::uint64_t PRIME1 = 11400714785074694791ull;
+constexpr std::uint64_t PRIME2 = 14029467366897019727ull;
+constexpr std::uint64_t PRIME3 = 1609587929392839161ull;
+constexpr std::uint64_t PRIME4 = 9650029242287828579ull;
+constexpr std::uint64_t PRIME5 = 2870177450012600261ull;
+
+std::uint64_t Read64(const std::uint8_t* p)
+{
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t Read32(const std::uint8_t* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint64_t Rotl(std::uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+std::uint64_t Round(std::uint64_t accumulator, std::uint64_t input)
+{
+    accumulator += input * PRIME2;
+    return Rotl(accumulator, 31) * PRIME1;
+}
+
+std::uint64_t MergeRound(std::uint64_t hash, std::uint64_t accumulator)
+{
+    hash ^= Round(0, accumulator);
+    return hash * PRIME1 + PRIME4;
+}
+
+}
+
+namespace XxHash {
+
+std::uint64_t Hash64(const void* data, std::size_t size, std::uint64_t seed)
+{
+    const auto* p = static_cast<const std::uint8_t*>(data);
+    const std::uint8_t* end = p + size;
+    std::uint64_t hash;
+
+    if (size >= 32) {
+        // four independent lanes over 32 byte stripes
+        std::uint64_t v1 = seed + PRIME1 + PRIME2;
+        std::uint64_t v2 = seed + PRIME2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - PRIME1;
+
+        const std::uint8_t* limit = end - 32;
+
+        do {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = Rotl(v1, 1) + Rotl(v2, 7) + Rotl(v3, 12) + Rotl(v4, 18);
+        hash = MergeRound(hash, v1);
+        hash = MergeRound(hash, v2);
+        hash = MergeRound(hash, v3);
+        hash = MergeRound(hash, v4);
+    } else {
+        hash = seed + PRIME5;
+    }
+
+    hash += size;
+
+    for (; p + 8 <= end; p += 8) {
+        hash ^= Round(0, Read64(p));
+        hash = Rotl(hash, 27) * PRIME1 + PRIME4;
+    }
+
+    if (p + 4 <= end) {
+        hash ^= Read32(p) * PRIME1;
+        hash = Rotl(hash, 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+
+    for (; p < end; p++) {
+        hash ^= *p * PRIME5;
+        hash = Rotl(hash, 11) * PRIME1;
+    }
+
+    // avalanche
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+}
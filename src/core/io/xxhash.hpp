@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Self-contained XXH64, matching the reference implementation bit for bit.
+// Fast enough to fingerprint whole asset files at load time; not suitable
+// where an attacker controls the input.
+namespace XxHash {
+
+std::uint64_t Hash64(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+// Fixed set of worker threads executing submitted jobs in FIFO order. Used
+// for CPU side work that must not run on the main thread, like reading and
+// decoding assets.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t threadCount = DefaultThreadCount())
+    {
+        mWorkers.reserve(threadCount);
+
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            mWorkers.emplace_back(&ThreadPool::Run, this);
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mRunning = false;
+        }
+        mWake.notify_all();
+
+        for (auto& worker : mWorkers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    std::future<std::invoke_result_t<F>> Submit(F&& job)
+    {
+        using Result = std::invoke_result_t<F>;
+
+        // packaged_task is move only, std::function needs a copyable target
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> future = task->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mJobs.emplace([task]() { (*task)(); });
+        }
+        mWake.notify_one();
+
+        return future;
+    }
+
+    std::size_t GetThreadCount() const
+    {
+        return mWorkers.size();
+    }
+
+    // Leaves one core to the main thread.
+    static std::size_t DefaultThreadCount()
+    {
+        return std::max<std::size_t>(1, std::thread::hardware_concurrency() - 1);
+    }
+
+private:
+    void Run()
+    {
+        while (true) {
+            std::function<void()> job;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWake.wait(lock, [this]() {
+                    return !mJobs.empty() || !mRunning;
+                });
+
+                // pending jobs are finished before shutting down
+                if (mJobs.empty()) {
+                    return;
+                }
+
+                job = std::move(mJobs.front());
+                mJobs.pop();
+            }
+
+            job();
+        }
+    }
+
+    std::vector<std::thread> mWorkers;
+    std::queue<std::function<void()>> mJobs;
+
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    bool mRunning = true;
+};
@@ -64,7 +64,7 @@ void Window::ResizeCallback(GLFWwindow *window, int width, int height) {
 void Window::KeyCallback([[maybe_unused]] GLFWwindow* window,
                         int key, int scancode, int action, int mods)
 {
-    gCoordinator.LogDebug("Key pressed: ", static_cast<char>(key));
+    BINLOG_DEBUG("Key pressed: {}", static_cast<char>(key));
     gCoordinator.SendEvent(Event(Events::Input::Async::Key::ID)
                 .SetParam(Events::Input::Async::Key::KEY, key)
                 .SetParam(Events::Input::Async::Key::SCANCODE, scancode)
@@ -21,26 +21,55 @@ DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::AddBinding(
   return *this;
 }
 
+DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::SetFlags(VkDescriptorSetLayoutCreateFlags flags) {
+  mFlags = flags;
+  return *this;
+}
+
+DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::SetBindingFlags(
+    uint32_t binding, VkDescriptorBindingFlags bindingFlags) {
+  assert(mBindings.count(binding) == 1 && "Binding flags for a binding that was not added");
+  mBindingFlags[binding] = bindingFlags;
+  return *this;
+}
+
 std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::Build() const {
-  return std::make_unique<DescriptorSetLayout>(mDevice, mBindings);
+  return std::make_unique<DescriptorSetLayout>(mDevice, mBindings, mBindingFlags, mFlags);
 }
 
 // *************** Descriptor Set Layout *********************
 
 DescriptorSetLayout::DescriptorSetLayout(
     std::shared_ptr<Device> device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
+    // Setting this flag tells the descriptor set layouts that no actual descriptor sets are allocated but instead pushed at command buffer creation time
+    : DescriptorSetLayout(device, bindings, {}, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR) {}
+
+DescriptorSetLayout::DescriptorSetLayout(
+    std::shared_ptr<Device> device,
+    std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+    const std::unordered_map<uint32_t, VkDescriptorBindingFlags> &bindingFlags,
+    VkDescriptorSetLayoutCreateFlags flags)
     : mDevice{device}, mBindings{bindings} {
   std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+  std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
   for (auto kv : bindings) {
     setLayoutBindings.push_back(kv.second);
+
+    auto it = bindingFlags.find(kv.first);
+    setLayoutBindingFlags.push_back(it != bindingFlags.end() ? it->second : 0);
   }
 
+  VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+  bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+  bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+
   VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
   descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  descriptorSetLayoutInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
   descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
   descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
-  // Setting this flag tells the descriptor set layouts that no actual descriptor sets are allocated but instead pushed at command buffer creation time
-	descriptorSetLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+  descriptorSetLayoutInfo.flags = flags;
 
   if (vkCreateDescriptorSetLayout(
           mDevice->GetDevice(),
@@ -18,14 +18,24 @@ public:
             VkDescriptorType descriptorType,
             VkShaderStageFlags stageFlags,
             uint32_t count = 1);
+        // Layouts are push descriptor layouts unless told otherwise
+        Builder &SetFlags(VkDescriptorSetLayoutCreateFlags flags);
+        Builder &SetBindingFlags(uint32_t binding, VkDescriptorBindingFlags bindingFlags);
         std::unique_ptr<DescriptorSetLayout> Build() const;
 
     private:
         std::shared_ptr<Device> mDevice;
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> mBindings{};
+        std::unordered_map<uint32_t, VkDescriptorBindingFlags> mBindingFlags{};
+        VkDescriptorSetLayoutCreateFlags mFlags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
     };
 
     DescriptorSetLayout(std::shared_ptr<Device> device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+    DescriptorSetLayout(
+        std::shared_ptr<Device> device,
+        std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+        const std::unordered_map<uint32_t, VkDescriptorBindingFlags> &bindingFlags,
+        VkDescriptorSetLayoutCreateFlags flags);
     ~DescriptorSetLayout();
     DescriptorSetLayout(const DescriptorSetLayout &) = delete;
     DescriptorSetLayout &operator=(const DescriptorSetLayout &) = delete;
@@ -52,6 +52,14 @@ void DestroyDebugUtilsMessengerEXT(
 
 // class member functions
 Device::Device(std::shared_ptr<Window>& window) : mWindow{window} {
+    Init();
+}
+
+Device::Device(bool dedicatedTransfer) : mDedicatedTransfer{dedicatedTransfer} {
+    Init();
+}
+
+void Device::Init() {
     CreateInstance();
     SetupDebugMessenger();
     CreateSurface();
@@ -59,9 +67,19 @@ Device::Device(std::shared_ptr<Window>& window) : mWindow{window} {
     CreateLogicalDevice();
     LoadExtensionFunctions();
     CreateCommandPool();
+
+    mAllocator = std::make_unique<MemoryAllocator>(mDevice, mPhysicalDevice, properties, mMemoryBudget);
+    mSamplerCache = std::make_unique<SamplerCache>(mDevice, properties);
 }
 
 Device::~Device() {
+    mSamplerCache.reset();
+    // reports whatever was not freed
+    mAllocator.reset();
+
+    if (mTransferCommandPool != mCommandPool) {
+        vkDestroyCommandPool(mDevice, mTransferCommandPool, nullptr);
+    }
     vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
     vkDestroyDevice(mDevice, nullptr);
 
@@ -69,7 +87,9 @@ Device::~Device() {
         DestroyDebugUtilsMessengerEXT(mInstance, mDebugMessenger, nullptr);
     }
 
-    vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+    if (mSurface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(mInstance, mSurface, nullptr);
+    }
     vkDestroyInstance(mInstance, nullptr);
 }
 
@@ -133,8 +153,8 @@ void Device::PickPhysicalDevice() {
             VkPhysicalDeviceProperties deviceProperties{};
             vkGetPhysicalDeviceProperties(device, &deviceProperties);
 
-            // force dedicated gpu
-            if (deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+            // force dedicated gpu, headless devices take whatever is there
+            if (mWindow && deviceProperties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
                 continue;
 
             mPhysicalDevice = device;
@@ -156,6 +176,10 @@ void Device::CreateLogicalDevice() {
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
 
+    if (indices.transferFamilyHasValue) {
+        uniqueQueueFamilies.insert(indices.transferFamily);
+    }
+
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo = {};
@@ -169,15 +193,34 @@ void Device::CreateLogicalDevice() {
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+    // optional, renderers fall back to push descriptors without it
+    mBindlessTextures = CheckBindlessTextureSupport(mPhysicalDevice);
+
+    VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+    indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+    // optional, memory statistics go without heap budgets
+    mMemoryBudget = CheckMemoryBudgetSupport(mPhysicalDevice);
+
+    std::vector<const char *> extensions = GetDeviceExtensions();
+
+    if (mMemoryBudget) {
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = mBindlessTextures ? &indexingFeatures : nullptr;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(mDeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = mDeviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+    createInfo.ppEnabledExtensionNames = extensions.data();
 
     // might not really be necessary anymore because device specific validation layers
     // have been deprecated
@@ -194,6 +237,16 @@ void Device::CreateLogicalDevice() {
 
     vkGetDeviceQueue(mDevice, indices.graphicsFamily, 0, &mGraphicsQueue);
     vkGetDeviceQueue(mDevice, indices.presentFamily, 0, &mPresentQueue);
+
+    mGraphicsQueueFamily = indices.graphicsFamily;
+
+    if (indices.transferFamilyHasValue) {
+        mTransferQueueFamily = indices.transferFamily;
+        vkGetDeviceQueue(mDevice, indices.transferFamily, 0, &mTransferQueue);
+    } else {
+        mTransferQueueFamily = indices.graphicsFamily;
+        mTransferQueue = mGraphicsQueue;
+    }
 }
 
 void Device::CreateCommandPool() {
@@ -208,9 +261,23 @@ void Device::CreateCommandPool() {
     if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, &mCommandPool) != VK_SUCCESS) {
         throw std::runtime_error("failed to create command pool!");
     }
+
+    mTransferCommandPool = mCommandPool;
+
+    if (queueFamilyIndices.transferFamilyHasValue) {
+        poolInfo.queueFamilyIndex = queueFamilyIndices.transferFamily;
+
+        if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, &mTransferCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create transfer command pool!");
+        }
+    }
 }
 
-void Device::CreateSurface() { mWindow->CreateWindowSurface(mInstance, &mSurface); }
+void Device::CreateSurface() {
+    if (mWindow) {
+        mWindow->CreateWindowSurface(mInstance, &mSurface);
+    }
+}
 
 bool Device::IsDeviceSuitable(VkPhysicalDevice device) {
     QueueFamilyIndices indices = FindQueueFamilies(device);
@@ -221,8 +288,9 @@ bool Device::IsDeviceSuitable(VkPhysicalDevice device) {
         throw std::runtime_error("Unsupported extensions");
     }
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    // nothing is presented without a surface
+    bool swapChainAdequate = mSurface == VK_NULL_HANDLE;
+    if (extensionsSupported && mSurface != VK_NULL_HANDLE) {
         SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
@@ -283,11 +351,15 @@ bool Device::CheckValidationLayerSupport() {
 }
 
 std::vector<const char *> Device::GetRequiredExtensions() {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char *> extensions;
 
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    if (mWindow) {
+        uint32_t glfwExtensionCount = 0;
+        const char **glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers) {
         extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -330,7 +402,8 @@ bool Device::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
         &extensionCount,
         availableExtensions.data());
 
-    std::set<std::string> requiredExtensions(mDeviceExtensions.begin(), mDeviceExtensions.end());
+    auto deviceExtensions = GetDeviceExtensions();
+    std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
     for (const auto &extension : availableExtensions) {
         requiredExtensions.erase(extension.extensionName);
@@ -339,6 +412,19 @@ bool Device::CheckDeviceExtensionSupport(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+std::vector<const char *> Device::GetDeviceExtensions() {
+    std::vector<const char *> extensions;
+
+    // the swap chain extension depends on the surface instance extensions
+    for (const char *extension : mDeviceExtensions) {
+        if (mSurface != VK_NULL_HANDLE || strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME) != 0) {
+            extensions.push_back(extension);
+        }
+    }
+
+    return extensions;
+}
+
 QueueFamilyIndices Device::FindQueueFamilies(VkPhysicalDevice device) {
     QueueFamilyIndices indices;
 
@@ -354,8 +440,13 @@ QueueFamilyIndices Device::FindQueueFamilies(VkPhysicalDevice device) {
             indices.graphicsFamily = i;
             indices.graphicsFamilyHasValue = true;
         }
+        // headless devices never present, the graphics family stands in
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
+        if (mSurface != VK_NULL_HANDLE) {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
+        } else {
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        }
         if (queueFamily.queueCount > 0 && presentSupport) {
             indices.presentFamily = i;
             indices.presentFamilyHasValue = true;
@@ -367,6 +458,23 @@ QueueFamilyIndices Device::FindQueueFamilies(VkPhysicalDevice device) {
         i++;
     }
 
+    // prefer a transfer only family (the DMA engines on discrete GPUs) over
+    // one that also supports compute
+    for (uint32_t family = 0; mDedicatedTransfer && family < queueFamilyCount; family++) {
+        VkQueueFlags flags = queueFamilies[family].queueFlags;
+
+        if (queueFamilies[family].queueCount == 0 ||
+            !(flags & VK_QUEUE_TRANSFER_BIT) ||
+            (flags & VK_QUEUE_GRAPHICS_BIT)) {
+            continue;
+        }
+
+        if (!indices.transferFamilyHasValue || !(flags & VK_QUEUE_COMPUTE_BIT)) {
+            indices.transferFamily = family;
+            indices.transferFamilyHasValue = true;
+        }
+    }
+
     return indices;
 }
 
@@ -430,30 +538,30 @@ void Device::CreateBuffer(
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer &buffer,
-    VkDeviceMemory &bufferMemory) {
+    MemoryAllocator::Allocation &bufferMemory,
+    bool sharedWithTransfer,
+    MemoryCategory category) {
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
     bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    uint32_t queueFamilies[] = {mGraphicsQueueFamily, mTransferQueueFamily};
+
+    if (sharedWithTransfer && mGraphicsQueueFamily != mTransferQueueFamily) {
+        bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        bufferInfo.queueFamilyIndexCount = 2;
+        bufferInfo.pQueueFamilyIndices = queueFamilies;
+    }
+
     if (vkCreateBuffer(mDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to create vertex buffer!");
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(mDevice, buffer, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate vertex buffer memory!");
-    }
+    bufferMemory = mAllocator->AllocateForBuffer(buffer, properties, category);
 
-    vkBindBufferMemory(mDevice, buffer, bufferMemory, 0);
+    vkBindBufferMemory(mDevice, buffer, bufferMemory.memory, bufferMemory.offset);
 }
 
 VkCommandBuffer Device::BeginSingleTimeCommands() {
@@ -503,9 +611,15 @@ void Device::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize siz
 void Device::CopyBufferToImage(
     VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
     VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+    RecordCopyBufferToImage(commandBuffer, buffer, image, width, height, layerCount);
+    EndSingleTimeCommands(commandBuffer);
+}
 
+void Device::RecordCopyBufferToImage(
+    VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount,
+    VkDeviceSize bufferOffset) {
     VkBufferImageCopy region{};
-    region.bufferOffset = 0;
+    region.bufferOffset = bufferOffset;
     region.bufferRowLength = 0;
     region.bufferImageHeight = 0;
 
@@ -524,38 +638,34 @@ void Device::CopyBufferToImage(
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
         1,
         &region);
-    EndSingleTimeCommands(commandBuffer);
 }
 
 void Device::CreateImageWithInfo(
     const VkImageCreateInfo &imageInfo,
     VkMemoryPropertyFlags properties,
     VkImage &image,
-    VkDeviceMemory &imageMemory) {
+    MemoryAllocator::Allocation &imageMemory,
+    MemoryCategory category) {
     if (vkCreateImage(mDevice, &imageInfo, nullptr, &image) != VK_SUCCESS) {
         throw std::runtime_error("failed to create image!");
     }
 
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(mDevice, image, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-    if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate image memory!");
-    }
+    imageMemory = mAllocator->AllocateForImage(image, imageInfo.tiling, properties, category);
 
-    if (vkBindImageMemory(mDevice, image, imageMemory, 0) != VK_SUCCESS) {
+    if (vkBindImageMemory(mDevice, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS) {
         throw std::runtime_error("failed to bind image memory!");
     }
 }
 
 void Device::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
     VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+    RecordTransitionImageLayout(commandBuffer, image, format, oldLayout, newLayout);
+    EndSingleTimeCommands(commandBuffer);
+}
 
+void Device::RecordTransitionImageLayout(
+    VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+    uint32_t mipLevels) {
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = oldLayout;
@@ -567,7 +677,7 @@ void Device::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = mipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
 
@@ -598,8 +708,65 @@ void Device::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout
         0, nullptr,
         1, &barrier
     );
+}
 
-    EndSingleTimeCommands(commandBuffer);
+bool Device::CheckBindlessTextureSupport(VkPhysicalDevice device) {
+    VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+    indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &indexingFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties = {};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+    VkPhysicalDeviceProperties2 deviceProperties = {};
+    deviceProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    deviceProperties.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2(device, &deviceProperties);
+
+    // textures are indexed with a push constant, which is dynamically
+    // uniform, so non uniform indexing is not needed
+    return indexingFeatures.descriptorBindingPartiallyBound &&
+           indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+           indexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+           indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages >= BINDLESS_TEXTURE_COUNT &&
+           indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages >= BINDLESS_TEXTURE_COUNT &&
+           indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers >= BINDLESS_TEXTURE_COUNT &&
+           indexingProperties.maxDescriptorSetUpdateAfterBindSamplers >= BINDLESS_TEXTURE_COUNT;
+}
+
+bool Device::CheckMemoryBudgetSupport(VkPhysicalDevice device) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(
+        device,
+        nullptr,
+        &extensionCount,
+        availableExtensions.data());
+
+    for (const auto &extension : availableExtensions) {
+        if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Device::SupportsLinearBlit(VkFormat format) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, format, &props);
+
+    VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT |
+                                    VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                    VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    return (props.optimalTilingFeatures & required) == required;
 }
 
 void Device::LoadExtensionFunctions() {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <core/window/window.hpp>
+#include <memory_allocator.hpp>
+#include <sampler_cache.hpp>
 
 // std lib headers
 #include <vector>
@@ -15,8 +17,11 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
     uint32_t graphicsFamily;
     uint32_t presentFamily;
+    // family without graphics support, copies there run alongside rendering
+    uint32_t transferFamily;
     bool graphicsFamilyHasValue = false;
     bool presentFamilyHasValue = false;
+    bool transferFamilyHasValue = false;
     bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
 };
 
@@ -29,6 +34,10 @@ public:
     #endif
 
     Device(std::shared_ptr<Window>& window);
+    // Headless, without surface or swap chain support, and any physical
+    // device type including software rasterizers. dedicatedTransfer false
+    // keeps uploads on the graphics queue even if a transfer family exists
+    explicit Device(bool dedicatedTransfer);
     ~Device();
 
     // Not copyable or movable
@@ -43,6 +52,13 @@ public:
     VkQueue GetGraphicsQueue() { return mGraphicsQueue; }
     VkQueue GetPresentQueue() { return mPresentQueue; }
 
+    // Without a dedicated transfer family these fall back to graphics
+    bool HasDedicatedTransferQueue() { return mTransferQueue != mGraphicsQueue; }
+    VkQueue GetTransferQueue() { return mTransferQueue; }
+    VkCommandPool GetTransferCommandPool() { return mTransferCommandPool; }
+    uint32_t GetGraphicsQueueFamily() { return mGraphicsQueueFamily; }
+    uint32_t GetTransferQueueFamily() { return mTransferQueueFamily; }
+
     SwapChainSupportDetails GetSwapChainSupport() { return QuerySwapChainSupport(mPhysicalDevice); }
     uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     QueueFamilyIndices FindPhysicalQueueFamilies() { return FindQueueFamilies(mPhysicalDevice); }
@@ -50,32 +66,67 @@ public:
         const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
     // Buffer Helper Functions
+
+    // sharedWithTransfer creates the buffer concurrent between the graphics
+    // and transfer families, so parts of it can be uploaded while the rest
+    // is in use without ownership transfers
     void CreateBuffer(
         VkDeviceSize size,
         VkBufferUsageFlags usage,
         VkMemoryPropertyFlags properties,
         VkBuffer &buffer,
-        VkDeviceMemory &bufferMemory);
+        MemoryAllocator::Allocation &bufferMemory,
+        bool sharedWithTransfer = false,
+        MemoryCategory category = MemoryCategory::OTHER);
     VkCommandBuffer BeginSingleTimeCommands();
     void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
     void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
     void CopyBufferToImage(
         VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
+    // category files the image's memory in the allocator statistics
     void CreateImageWithInfo(
         const VkImageCreateInfo &imageInfo,
         VkMemoryPropertyFlags properties,
         VkImage &image,
-        VkDeviceMemory &imageMemory);
+        MemoryAllocator::Allocation &imageMemory,
+        MemoryCategory category = MemoryCategory::OTHER);
 
     void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
 
+    // Record variants of the helpers above, for batching several uploads
+    // into a single submission
+    void RecordCopyBufferToImage(
+        VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount,
+        VkDeviceSize bufferOffset = 0);
+    void RecordTransitionImageLayout(
+        VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout,
+        uint32_t mipLevels = 1);
+
+    // True if images of format can be mip mapped with linear filtered blits
+    bool SupportsLinearBlit(VkFormat format);
+
+    // True if descriptor indexing was enabled with everything a bindless
+    // texture table of BINDLESS_TEXTURE_COUNT sampled images needs
+    bool SupportsBindlessTextures() { return mBindlessTextures; }
+    static constexpr uint32_t BINDLESS_TEXTURE_COUNT = 4096;
+
+    // Samplers shared by all textures of this device
+    SamplerCache& GetSamplerCache() { return *mSamplerCache; }
+
+    // Device memory of every buffer and image, see MemoryAllocator
+    MemoryAllocator& GetAllocator() { return *mAllocator; }
+    // True if VK_EXT_memory_budget was enabled, the allocator statistics
+    // then carry heap budgets and usage
+    bool SupportsMemoryBudget() { return mMemoryBudget; }
+
     VkPhysicalDeviceProperties properties;
 
     // dynamically linked functions
     PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR{ VK_NULL_HANDLE };
     
 private:
+    void Init();
     void CreateInstance();
     void SetupDebugMessenger();
     void CreateSurface();
@@ -87,11 +138,14 @@ private:
     // helper functions
     bool IsDeviceSuitable(VkPhysicalDevice device);
     std::vector<const char *> GetRequiredExtensions();
+    std::vector<const char *> GetDeviceExtensions();
     bool CheckValidationLayerSupport();
     QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
     void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
     void HasGflwRequiredInstanceExtensions();
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+    bool CheckBindlessTextureSupport(VkPhysicalDevice device);
+    bool CheckMemoryBudgetSupport(VkPhysicalDevice device);
     SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
 
     VkInstance mInstance;
@@ -99,11 +153,23 @@ private:
     VkPhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
     std::shared_ptr<Window> mWindow;
     VkCommandPool mCommandPool;
+    VkCommandPool mTransferCommandPool;
 
     VkDevice mDevice;
-    VkSurfaceKHR mSurface;
+    VkSurfaceKHR mSurface = VK_NULL_HANDLE;
     VkQueue mGraphicsQueue;
     VkQueue mPresentQueue;
+    VkQueue mTransferQueue;
+
+    uint32_t mGraphicsQueueFamily;
+    uint32_t mTransferQueueFamily;
+
+    bool mDedicatedTransfer = true;
+    bool mBindlessTextures = false;
+    bool mMemoryBudget = false;
+
+    std::unique_ptr<SamplerCache> mSamplerCache;
+    std::unique_ptr<MemoryAllocator> mAllocator;
 
     const std::vector<const char *> mValidationLayers = {"VK_LAYER_KHRONOS_validation"};
     const std::vector<const char *> mDeviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME,
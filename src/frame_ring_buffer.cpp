@@ -0,0 +1,57 @@
+#include <frame_ring_buffer.hpp>
+
+#include <swap_chain.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+FrameRingBuffer::FrameRingBuffer(std::shared_ptr<Device> device, VkDeviceSize frameSize) {
+    const VkPhysicalDeviceLimits& limits = device->properties.limits;
+    mAlignment = std::max({VkDeviceSize{16},
+                           limits.minUniformBufferOffsetAlignment,
+                           limits.minStorageBufferOffsetAlignment});
+
+    // every region starts aligned
+    mFrameSize = (frameSize + mAlignment - 1) / mAlignment * mAlignment;
+
+    mBuffer = std::make_unique<Buffer>(
+        device,
+        mFrameSize,
+        SwapChain::MAX_FRAMES_IN_FLIGHT,
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        1,
+        false,
+        MemoryCategory::FRAME_DATA
+    );
+
+    if (mBuffer->Map() != VK_SUCCESS) {
+        throw std::runtime_error("failed to map frame ring buffer");
+    }
+
+    mMapped = static_cast<char *>(mBuffer->GetMappedMemory());
+}
+
+void FrameRingBuffer::BeginFrame(uint32_t frameIndex) {
+    mFrameStart = frameIndex * mFrameSize;
+    mHead = mFrameStart;
+}
+
+FrameRingBuffer::Allocation FrameRingBuffer::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    if (alignment == 0) {
+        alignment = mAlignment;
+    }
+
+    VkDeviceSize offset = (mHead + alignment - 1) / alignment * alignment;
+
+    if (offset + size > mFrameStart + mFrameSize) {
+        throw std::runtime_error("frame ring buffer exhausted, " + std::to_string(size) + " bytes requested with " +
+                                 std::to_string(mFrameStart + mFrameSize - mHead) + " left");
+    }
+
+    mHead = offset + size;
+    return {mBuffer->GetBuffer(), offset, mMapped + offset};
+}
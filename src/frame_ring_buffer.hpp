@@ -0,0 +1,63 @@
+#pragma once
+
+#include <device.hpp>
+#include <buffer.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+
+// Transient per frame data: uniforms, vertices, instance data. One host
+// visible buffer, mapped once and split into a region per frame in flight.
+// Allocations bump through the region of the current frame and are never
+// freed individually, the whole region is recycled once the frame's fence
+// has signaled and it comes around again.
+class FrameRingBuffer {
+public:
+    // room for the instance data of 100k sprites
+    static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 8 * 1024 * 1024;
+
+    struct Allocation {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        // from the start of the buffer, for descriptors and binds
+        VkDeviceSize offset = 0;
+        void *data = nullptr;
+    };
+
+    FrameRingBuffer(std::shared_ptr<Device> device, VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+
+    FrameRingBuffer(const FrameRingBuffer &) = delete;
+    FrameRingBuffer &operator=(const FrameRingBuffer &) = delete;
+
+    // Starts handing out the region of frameIndex. Only once the GPU is
+    // done with the previous frame that used it
+    void BeginFrame(uint32_t frameIndex);
+
+    // Valid until the end of the frame. Alignment 0 aligns for uniform and
+    // storage buffer offsets, which suits vertex data as well. Throws when
+    // the region of the frame is used up
+    Allocation Allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+    template<typename T>
+    Allocation Push(const T &value) {
+        Allocation allocation = Allocate(sizeof(T));
+        *static_cast<T *>(allocation.data) = value;
+        return allocation;
+    }
+
+    VkBuffer GetBuffer() const { return mBuffer->GetBuffer(); }
+    VkDeviceSize GetFrameSize() const { return mFrameSize; }
+
+    // Bytes the current frame has used so far
+    VkDeviceSize GetUsedBytes() const { return mHead - mFrameStart; }
+
+private:
+    std::unique_ptr<Buffer> mBuffer;
+    char *mMapped = nullptr;
+
+    VkDeviceSize mFrameSize;
+    VkDeviceSize mAlignment;
+
+    VkDeviceSize mFrameStart = 0;
+    VkDeviceSize mHead = 0;
+};
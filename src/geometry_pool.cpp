@@ -0,0 +1,122 @@
+#include <geometry_pool.hpp>
+
+// std
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+GeometryPool::GeometryPool(std::shared_ptr<Device> device, VkDeviceSize vertexCapacity, VkDeviceSize indexCapacity) :
+    mVertexRanges(vertexCapacity),
+    mIndexRanges(indexCapacity) {
+    mVertexBuffer = std::make_unique<Buffer>(
+        device,
+        vertexCapacity,
+        1,
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        1,
+        true,
+        MemoryCategory::GEOMETRY
+    );
+
+    mIndexBuffer = std::make_unique<Buffer>(
+        device,
+        indexCapacity,
+        1,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        1,
+        true,
+        MemoryCategory::GEOMETRY
+    );
+}
+
+GeometryPool::Range GeometryPool::AllocateVertices(const void *data, VkDeviceSize size, VkDeviceSize stride,
+                                                   UploadManager &uploadManager) {
+    return Allocate(*mVertexBuffer, mVertexRanges, data, size, stride, uploadManager);
+}
+
+GeometryPool::Range GeometryPool::AllocateIndices(const void *data, VkDeviceSize size, VkDeviceSize stride,
+                                                  UploadManager &uploadManager) {
+    return Allocate(*mIndexBuffer, mIndexRanges, data, size, stride, uploadManager);
+}
+
+void GeometryPool::FreeVertices(const Range &range) {
+    mVertexRanges.Free(range.offset, range.size);
+}
+
+void GeometryPool::FreeIndices(const Range &range) {
+    mIndexRanges.Free(range.offset, range.size);
+}
+
+void GeometryPool::Bind(VkCommandBuffer commandBuffer, VkIndexType indexType) {
+    VkBuffer buffers[] = {mVertexBuffer->GetBuffer()};
+    VkDeviceSize offsets[] = {0};
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer->GetBuffer(), 0, indexType);
+}
+
+GeometryPool::Range GeometryPool::Allocate(Buffer &buffer, FreeList &freeList, const void *data, VkDeviceSize size,
+                                           VkDeviceSize stride, UploadManager &uploadManager) {
+    std::optional<VkDeviceSize> offset = freeList.Allocate(size, stride);
+
+    if (!offset) {
+        throw std::runtime_error("geometry pool is out of space for " + std::to_string(size) + " bytes");
+    }
+
+    uploadManager.UploadSharedBuffer(buffer.GetBuffer(), data, size, *offset);
+    return {*offset, size};
+}
+
+GeometryPool::FreeList::FreeList(VkDeviceSize capacity) {
+    mFreeRanges[0] = capacity;
+}
+
+std::optional<VkDeviceSize> GeometryPool::FreeList::Allocate(VkDeviceSize size, VkDeviceSize alignment) {
+    for (auto it = mFreeRanges.begin(); it != mFreeRanges.end(); ++it) {
+        VkDeviceSize start = it->first;
+        VkDeviceSize end = start + it->second;
+
+        // strides like 12 or 48 bytes are not powers of two
+        VkDeviceSize aligned = (start + alignment - 1) / alignment * alignment;
+
+        if (aligned + size > end) {
+            continue;
+        }
+
+        mFreeRanges.erase(it);
+
+        // padding in front and the tail stay free
+        if (aligned > start) {
+            mFreeRanges[start] = aligned - start;
+        }
+        if (aligned + size < end) {
+            mFreeRanges[aligned + size] = end - aligned - size;
+        }
+
+        return aligned;
+    }
+
+    return std::nullopt;
+}
+
+void GeometryPool::FreeList::Free(VkDeviceSize offset, VkDeviceSize size) {
+    auto next = mFreeRanges.lower_bound(offset);
+
+    if (next != mFreeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = mFreeRanges.erase(next);
+    }
+
+    if (next != mFreeRanges.begin()) {
+        auto previous = std::prev(next);
+
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    mFreeRanges[offset] = size;
+}
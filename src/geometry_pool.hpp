@@ -0,0 +1,72 @@
+#pragma once
+
+#include <device.hpp>
+#include <buffer.hpp>
+#include <upload_manager.hpp>
+
+// std
+#include <map>
+#include <memory>
+#include <optional>
+
+// One device local vertex buffer and one index buffer shared by every
+// model. Models own ranges of them handed out by first fit free lists, so
+// loading a model allocates no device memory and consecutive draws keep
+// the same buffers bound. Ranges start at a multiple of the element size,
+// so draws address them with firstIndex and vertexOffset alone and an
+// indirect draw can reach any model.
+class GeometryPool {
+public:
+    static constexpr VkDeviceSize DEFAULT_VERTEX_CAPACITY = 32 * 1024 * 1024;
+    static constexpr VkDeviceSize DEFAULT_INDEX_CAPACITY = 16 * 1024 * 1024;
+
+    struct Range {
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+    };
+
+    GeometryPool(std::shared_ptr<Device> device,
+                 VkDeviceSize vertexCapacity = DEFAULT_VERTEX_CAPACITY,
+                 VkDeviceSize indexCapacity = DEFAULT_INDEX_CAPACITY);
+
+    GeometryPool(const GeometryPool &) = delete;
+    GeometryPool &operator=(const GeometryPool &) = delete;
+
+    // Copies data into a new range through the upload manager. stride is
+    // the vertex or index size, the range offset is a multiple of it.
+    // Throws when the pool is out of space
+    Range AllocateVertices(const void *data, VkDeviceSize size, VkDeviceSize stride, UploadManager &uploadManager);
+    Range AllocateIndices(const void *data, VkDeviceSize size, VkDeviceSize stride, UploadManager &uploadManager);
+
+    // Only once no frame in flight draws from the range anymore
+    void FreeVertices(const Range &range);
+    void FreeIndices(const Range &range);
+
+    // Binding point for every model, with the index type of the next draws
+    void Bind(VkCommandBuffer commandBuffer, VkIndexType indexType);
+
+    VkBuffer GetVertexBuffer() const { return mVertexBuffer->GetBuffer(); }
+    VkBuffer GetIndexBuffer() const { return mIndexBuffer->GetBuffer(); }
+
+private:
+    // free ranges by offset, neighbours merge on free
+    class FreeList {
+    public:
+        explicit FreeList(VkDeviceSize capacity);
+
+        std::optional<VkDeviceSize> Allocate(VkDeviceSize size, VkDeviceSize alignment);
+        void Free(VkDeviceSize offset, VkDeviceSize size);
+
+    private:
+        std::map<VkDeviceSize, VkDeviceSize> mFreeRanges;
+    };
+
+    Range Allocate(Buffer &buffer, FreeList &freeList, const void *data, VkDeviceSize size,
+                   VkDeviceSize stride, UploadManager &uploadManager);
+
+    std::unique_ptr<Buffer> mVertexBuffer;
+    std::unique_ptr<Buffer> mIndexBuffer;
+
+    FreeList mVertexRanges;
+    FreeList mIndexRanges;
+};
@@ -14,6 +14,7 @@ int main() {
         app.Run();
     } catch (const std::exception& e) {
         gCoordinator.LogError(e.what());
+        gCoordinator.FlushLog();
         return EXIT_FAILURE;
     }
 
@@ -0,0 +1,501 @@
+#include <memory_allocator.hpp>
+
+#include "core/coordinator.hpp"
+
+// std
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+extern Coordinator gCoordinator;
+
+const char *MemoryCategoryName(MemoryCategory category) {
+    switch (category) {
+        case MemoryCategory::TEXTURE:
+            return "texture";
+        case MemoryCategory::GEOMETRY:
+            return "geometry";
+        case MemoryCategory::STAGING:
+            return "staging";
+        case MemoryCategory::FRAME_DATA:
+            return "frame data";
+        case MemoryCategory::SWAPCHAIN:
+            return "swapchain";
+        default:
+            return "other";
+    }
+}
+
+struct MemoryAllocator::Block {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    void *mapped = nullptr;
+    uint32_t order = 0;
+    uint32_t allocationCount = 0;
+    // offsets of free pieces of each order, index order - MIN_ORDER
+    std::vector<std::set<VkDeviceSize>> freeLists;
+};
+
+MemoryAllocator::MemoryAllocator(VkDevice device,
+                                 VkPhysicalDevice physicalDevice,
+                                 const VkPhysicalDeviceProperties& properties,
+                                 bool memoryBudget) :
+    mDevice(device),
+    mPhysicalDevice(physicalDevice),
+    mMemoryBudget(memoryBudget),
+    mNonCoherentAtomSize(properties.limits.nonCoherentAtomSize) {
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &mMemoryProperties);
+
+    mPools.resize(mMemoryProperties.memoryTypeCount * 2);
+    mStats.memoryTypes.resize(mMemoryProperties.memoryTypeCount);
+
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++) {
+        mStats.memoryTypes[i].flags = mMemoryProperties.memoryTypes[i].propertyFlags;
+        mStats.memoryTypes[i].heapIndex = mMemoryProperties.memoryTypes[i].heapIndex;
+    }
+
+    // small heaps, like the host visible part of device memory, get
+    // smaller blocks so one block does not take a large share of them
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++) {
+        VkDeviceSize heapSize = mMemoryProperties.memoryHeaps[mMemoryProperties.memoryTypes[i].heapIndex].size;
+        uint32_t order = MAX_BLOCK_ORDER;
+
+        while (order > MIN_BLOCK_ORDER && (VkDeviceSize{1} << order) > heapSize / 8) {
+            order--;
+        }
+
+        mBlockOrders.push_back(order);
+    }
+}
+
+MemoryAllocator::~MemoryAllocator() {
+    if (!mLive.empty()) {
+        gCoordinator.LogError("memory allocator: ", mLive.size(), " allocations leaked");
+
+        for (const auto& [key, live] : mLive) {
+            gCoordinator.LogError("    ", MemoryCategoryName(live.category), ": ", live.size, " bytes");
+        }
+    }
+
+    for (const auto& pool : mPools) {
+        for (const auto& block : pool) {
+            vkFreeMemory(mDevice, block->memory, nullptr);
+        }
+    }
+
+    // leaked dedicated allocations still own their memory
+    for (const auto& [key, live] : mLive) {
+        if (live.dedicated) {
+            vkFreeMemory(mDevice, key.first, nullptr);
+        }
+    }
+}
+
+MemoryAllocator::Allocation MemoryAllocator::AllocateForBuffer(VkBuffer buffer,
+                                                               VkMemoryPropertyFlags properties,
+                                                               MemoryCategory category) {
+    VkBufferMemoryRequirementsInfo2 requirementsInfo{};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.buffer = buffer;
+
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 requirements{};
+    requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements.pNext = &dedicatedRequirements;
+
+    vkGetBufferMemoryRequirements2(mDevice, &requirementsInfo, &requirements);
+
+    VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    dedicatedInfo.buffer = buffer;
+
+    return Allocate(requirements.memoryRequirements,
+                    dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation,
+                    false,
+                    properties,
+                    dedicatedInfo,
+                    category);
+}
+
+MemoryAllocator::Allocation MemoryAllocator::AllocateForImage(VkImage image,
+                                                              VkImageTiling tiling,
+                                                              VkMemoryPropertyFlags properties,
+                                                              MemoryCategory category) {
+    VkImageMemoryRequirementsInfo2 requirementsInfo{};
+    requirementsInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2;
+    requirementsInfo.image = image;
+
+    VkMemoryDedicatedRequirements dedicatedRequirements{};
+    dedicatedRequirements.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS;
+
+    VkMemoryRequirements2 requirements{};
+    requirements.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+    requirements.pNext = &dedicatedRequirements;
+
+    vkGetImageMemoryRequirements2(mDevice, &requirementsInfo, &requirements);
+
+    VkMemoryDedicatedAllocateInfo dedicatedInfo{};
+    dedicatedInfo.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO;
+    dedicatedInfo.image = image;
+
+    return Allocate(requirements.memoryRequirements,
+                    dedicatedRequirements.prefersDedicatedAllocation || dedicatedRequirements.requiresDedicatedAllocation,
+                    tiling == VK_IMAGE_TILING_OPTIMAL,
+                    properties,
+                    dedicatedInfo,
+                    category);
+}
+
+MemoryAllocator::Allocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements,
+                                                      bool dedicatedPreferred,
+                                                      bool optimalTiling,
+                                                      VkMemoryPropertyFlags properties,
+                                                      const VkMemoryDedicatedAllocateInfo& dedicatedInfo,
+                                                      MemoryCategory category) {
+    uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+    VkMemoryPropertyFlags typeFlags = mMemoryProperties.memoryTypes[memoryType].propertyFlags;
+
+    // flushes of non coherent memory work in whole atoms, an allocation
+    // must not share one with its neighbour
+    VkDeviceSize size = requirements.size;
+    VkDeviceSize alignment = requirements.alignment;
+
+    if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+        size = (size + mNonCoherentAtomSize - 1) / mNonCoherentAtomSize * mNonCoherentAtomSize;
+        alignment = std::max(alignment, mNonCoherentAtomSize);
+    }
+
+    uint32_t order = std::max<uint32_t>(MIN_ORDER, std::bit_width(std::max(size, alignment) - 1));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Allocation allocation;
+    allocation.size = size;
+    allocation.order = order;
+
+    if (dedicatedPreferred || order >= mBlockOrders[memoryType]) {
+        // the memory is the resource's alone, there is no neighbour to
+        // round for. Dedicated allocations must be exactly the required
+        // size, and only name their resource when the driver asked for it
+        size = requirements.size;
+        allocation.size = size;
+        allocation.memory = AllocateDeviceMemory(size,
+                                                 memoryType,
+                                                 dedicatedPreferred ? &dedicatedInfo : nullptr,
+                                                 &allocation.mapped);
+
+        AddReserved(memoryType, size);
+        mStats.dedicatedCount++;
+    } else {
+        std::vector<std::unique_ptr<Block>>& pool = mPools[memoryType * 2 + (optimalTiling ? 1 : 0)];
+        Block *block = nullptr;
+        uint32_t freeOrder = 0;
+
+        // smallest free piece that fits, in any block
+        for (const auto& candidate : pool) {
+            for (uint32_t i = order; i <= candidate->order; i++) {
+                if (!candidate->freeLists[i - MIN_ORDER].empty() && (!block || i < freeOrder)) {
+                    block = candidate.get();
+                    freeOrder = i;
+                    break;
+                }
+            }
+        }
+
+        if (!block) {
+            block = CreateBlock(memoryType, optimalTiling);
+            freeOrder = block->order;
+        }
+
+        auto& freeList = block->freeLists[freeOrder - MIN_ORDER];
+        VkDeviceSize offset = *freeList.begin();
+        freeList.erase(freeList.begin());
+
+        // split down to the requested size, the upper halves stay free
+        while (freeOrder > order) {
+            freeOrder--;
+            block->freeLists[freeOrder - MIN_ORDER].insert(offset + (VkDeviceSize{1} << freeOrder));
+        }
+
+        block->allocationCount++;
+
+        allocation.memory = block->memory;
+        allocation.offset = offset;
+        allocation.block = block;
+
+        if (block->mapped) {
+            allocation.mapped = static_cast<char *>(block->mapped) + offset;
+        }
+
+    }
+
+    // dedicated allocations are exactly the size they were asked for
+    VkDeviceSize allocated = allocation.block ? VkDeviceSize{1} << order : size;
+    MemoryTypeStats& typeStats = mStats.memoryTypes[memoryType];
+    CategoryStats& categoryStats = mStats.categories[static_cast<size_t>(category)];
+
+    mStats.allocationCount++;
+    mStats.allocatedBytes += allocated;
+    mStats.peakAllocatedBytes = std::max(mStats.peakAllocatedBytes, mStats.allocatedBytes);
+    mStats.requestedBytes += size;
+
+    typeStats.allocationCount++;
+    typeStats.allocatedBytes += allocated;
+
+    categoryStats.allocationCount++;
+    categoryStats.bytes += size;
+    categoryStats.peakBytes = std::max(categoryStats.peakBytes, categoryStats.bytes);
+
+    mLive[{allocation.memory, allocation.offset}] = {size, category, memoryType, allocation.block == nullptr};
+
+    return allocation;
+}
+
+void MemoryAllocator::Free(const Allocation& allocation) {
+    if (allocation.memory == VK_NULL_HANDLE) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto live = mLive.find({allocation.memory, allocation.offset});
+    assert(live != mLive.end() && "Freeing memory that was not allocated.");
+
+    uint32_t memoryType = live->second.memoryType;
+    CategoryStats& categoryStats = mStats.categories[static_cast<size_t>(live->second.category)];
+    mLive.erase(live);
+
+    Block *block = allocation.block;
+    VkDeviceSize allocated = block ? VkDeviceSize{1} << allocation.order : allocation.size;
+
+    mStats.allocationCount--;
+    mStats.allocatedBytes -= allocated;
+    mStats.requestedBytes -= allocation.size;
+
+    mStats.memoryTypes[memoryType].allocationCount--;
+    mStats.memoryTypes[memoryType].allocatedBytes -= allocated;
+
+    categoryStats.allocationCount--;
+    categoryStats.bytes -= allocation.size;
+
+    if (!block) {
+        vkFreeMemory(mDevice, allocation.memory, nullptr);
+
+        RemoveReserved(memoryType, allocation.size);
+        mStats.dedicatedCount--;
+        return;
+    }
+
+    // merge with the buddy for as long as it is free too
+    VkDeviceSize offset = allocation.offset;
+    uint32_t order = allocation.order;
+
+    while (order < block->order) {
+        auto& freeList = block->freeLists[order - MIN_ORDER];
+        auto buddy = freeList.find(offset ^ (VkDeviceSize{1} << order));
+
+        if (buddy == freeList.end()) {
+            break;
+        }
+
+        freeList.erase(buddy);
+        offset &= ~(VkDeviceSize{1} << order);
+        order++;
+    }
+
+    block->freeLists[order - MIN_ORDER].insert(offset);
+
+    // keep one block per pool around, loads tend to come in waves
+    if (--block->allocationCount > 0) {
+        return;
+    }
+
+    for (auto& pool : mPools) {
+        auto it = std::find_if(pool.begin(), pool.end(), [block](const auto& candidate) {
+            return candidate.get() == block;
+        });
+
+        if (it == pool.end()) {
+            continue;
+        }
+
+        if (pool.size() > 1) {
+            RemoveReserved(memoryType, VkDeviceSize{1} << block->order);
+
+            vkFreeMemory(mDevice, block->memory, nullptr);
+            pool.erase(it);
+        }
+
+        return;
+    }
+}
+
+MemoryAllocator::Stats MemoryAllocator::GetStats() const {
+    Stats stats;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        stats = mStats;
+    }
+
+    stats.heaps.resize(mMemoryProperties.memoryHeapCount);
+
+    for (uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; i++) {
+        stats.heaps[i].size = mMemoryProperties.memoryHeaps[i].size;
+        stats.heaps[i].flags = mMemoryProperties.memoryHeaps[i].flags;
+    }
+
+    for (const MemoryTypeStats& type : stats.memoryTypes) {
+        stats.heaps[type.heapIndex].reservedBytes += type.reservedBytes;
+    }
+
+    if (mMemoryBudget) {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budget;
+
+        vkGetPhysicalDeviceMemoryProperties2(mPhysicalDevice, &properties);
+
+        for (uint32_t i = 0; i < mMemoryProperties.memoryHeapCount; i++) {
+            stats.heaps[i].budgetBytes = budget.heapBudget[i];
+            stats.heaps[i].usageBytes = budget.heapUsage[i];
+        }
+
+        stats.budgetAvailable = true;
+    }
+
+    return stats;
+}
+
+std::string MemoryAllocator::Stats::ToJson() const {
+    std::ostringstream out;
+
+    out << "{\"deviceAllocations\":" << deviceAllocationCount
+        << ",\"dedicated\":" << dedicatedCount
+        << ",\"allocations\":" << allocationCount
+        << ",\"reservedBytes\":" << reservedBytes
+        << ",\"peakReservedBytes\":" << peakReservedBytes
+        << ",\"allocatedBytes\":" << allocatedBytes
+        << ",\"peakAllocatedBytes\":" << peakAllocatedBytes
+        << ",\"requestedBytes\":" << requestedBytes;
+
+    out << ",\"categories\":{";
+
+    for (size_t i = 0; i < categories.size(); i++) {
+        out << (i > 0 ? "," : "") << "\"" << MemoryCategoryName(static_cast<MemoryCategory>(i)) << "\":{"
+            << "\"allocations\":" << categories[i].allocationCount
+            << ",\"bytes\":" << categories[i].bytes
+            << ",\"peakBytes\":" << categories[i].peakBytes << "}";
+    }
+
+    out << "},\"memoryTypes\":[";
+
+    for (size_t i = 0; i < memoryTypes.size(); i++) {
+        out << (i > 0 ? "," : "") << "{"
+            << "\"flags\":" << memoryTypes[i].flags
+            << ",\"heap\":" << memoryTypes[i].heapIndex
+            << ",\"deviceAllocations\":" << memoryTypes[i].deviceAllocationCount
+            << ",\"allocations\":" << memoryTypes[i].allocationCount
+            << ",\"reservedBytes\":" << memoryTypes[i].reservedBytes
+            << ",\"allocatedBytes\":" << memoryTypes[i].allocatedBytes << "}";
+    }
+
+    out << "],\"heaps\":[";
+
+    for (size_t i = 0; i < heaps.size(); i++) {
+        out << (i > 0 ? "," : "") << "{"
+            << "\"size\":" << heaps[i].size
+            << ",\"deviceLocal\":" << ((heaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "true" : "false")
+            << ",\"reservedBytes\":" << heaps[i].reservedBytes;
+
+        if (budgetAvailable) {
+            out << ",\"budgetBytes\":" << heaps[i].budgetBytes
+                << ",\"usageBytes\":" << heaps[i].usageBytes;
+        }
+
+        out << "}";
+    }
+
+    out << "]}";
+    return out.str();
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) &&
+            (mMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VkDeviceMemory MemoryAllocator::AllocateDeviceMemory(VkDeviceSize size,
+                                                     uint32_t memoryType,
+                                                     const void *next,
+                                                     void **mapped) {
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.pNext = next;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkDeviceMemory memory;
+
+    if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate device memory");
+    }
+
+    *mapped = nullptr;
+
+    if (mMemoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        if (vkMapMemory(mDevice, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+            vkFreeMemory(mDevice, memory, nullptr);
+            throw std::runtime_error("failed to map device memory");
+        }
+    }
+
+    return memory;
+}
+
+MemoryAllocator::Block *MemoryAllocator::CreateBlock(uint32_t memoryType, bool optimalTiling) {
+    auto block = std::make_unique<Block>();
+    block->order = mBlockOrders[memoryType];
+    block->memory = AllocateDeviceMemory(VkDeviceSize{1} << block->order, memoryType, nullptr, &block->mapped);
+    block->freeLists.resize(block->order - MIN_ORDER + 1);
+    block->freeLists.back().insert(0);
+
+    AddReserved(memoryType, VkDeviceSize{1} << block->order);
+
+    gCoordinator.LogDebug("memory allocator: new ", (VkDeviceSize{1} << block->order) / (1024 * 1024),
+                          " MiB block of memory type ", memoryType);
+
+    std::vector<std::unique_ptr<Block>>& pool = mPools[memoryType * 2 + (optimalTiling ? 1 : 0)];
+    pool.push_back(std::move(block));
+    return pool.back().get();
+}
+
+void MemoryAllocator::AddReserved(uint32_t memoryType, VkDeviceSize size) {
+    mStats.deviceAllocationCount++;
+    mStats.reservedBytes += size;
+    mStats.peakReservedBytes = std::max(mStats.peakReservedBytes, mStats.reservedBytes);
+
+    mStats.memoryTypes[memoryType].deviceAllocationCount++;
+    mStats.memoryTypes[memoryType].reservedBytes += size;
+}
+
+void MemoryAllocator::RemoveReserved(uint32_t memoryType, VkDeviceSize size) {
+    mStats.deviceAllocationCount--;
+    mStats.reservedBytes -= size;
+
+    mStats.memoryTypes[memoryType].deviceAllocationCount--;
+    mStats.memoryTypes[memoryType].reservedBytes -= size;
+}
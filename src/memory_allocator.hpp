@@ -0,0 +1,184 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <string>
+#include <vector>
+
+// What a piece of memory is used for, the statistics are kept per category
+enum class MemoryCategory : uint8_t {
+    OTHER,
+    TEXTURE,
+    GEOMETRY,
+    STAGING,
+    FRAME_DATA,
+    SWAPCHAIN,
+    COUNT
+};
+
+const char *MemoryCategoryName(MemoryCategory category);
+
+// Sub-allocates device memory out of large blocks, so buffers and images
+// cost a vkAllocateMemory call only when a new block is needed. Drivers cap
+// the number of live allocations and every call is slow.
+//
+// Each memory type has its own blocks, split with a buddy scheme: a block
+// of 2^n bytes is halved until the request fits, freed halves merge with
+// their buddy again. Offsets are aligned to the size of the piece they
+// get, which covers any power of two alignment. Linear resources (buffers)
+// and optimal tiling images never share a block, so
+// bufferImageGranularity cannot be violated. Images the driver wants to
+// own their memory, and anything larger than half a block, get a dedicated
+// allocation.
+//
+// Host visible blocks are mapped once for their whole lifetime, several
+// buffers can live in the same VkDeviceMemory and it cannot be mapped
+// twice. Thread safe.
+class MemoryAllocator {
+public:
+    // defined in the source file
+    struct Block;
+
+    struct Allocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        // start of the allocation for host visible memory, nullptr otherwise
+        void *mapped = nullptr;
+
+    private:
+        friend class MemoryAllocator;
+
+        // nullptr for dedicated allocations
+        Block *block = nullptr;
+        uint32_t order = 0;
+    };
+
+    struct CategoryStats {
+        uint32_t allocationCount = 0;
+        // what the resources asked for
+        VkDeviceSize bytes = 0;
+        VkDeviceSize peakBytes = 0;
+    };
+
+    struct MemoryTypeStats {
+        VkMemoryPropertyFlags flags = 0;
+        uint32_t heapIndex = 0;
+        uint32_t deviceAllocationCount = 0;
+        uint32_t allocationCount = 0;
+        VkDeviceSize reservedBytes = 0;
+        VkDeviceSize allocatedBytes = 0;
+    };
+
+    struct HeapStats {
+        VkDeviceSize size = 0;
+        VkMemoryHeapFlags flags = 0;
+        // held by this allocator
+        VkDeviceSize reservedBytes = 0;
+        // from VK_EXT_memory_budget, zero without it. Usage is process
+        // wide, it includes memory the allocator never sees like the
+        // swapchain's color images
+        VkDeviceSize budgetBytes = 0;
+        VkDeviceSize usageBytes = 0;
+    };
+
+    struct Stats {
+        // vkAllocateMemory calls currently alive
+        uint32_t deviceAllocationCount = 0;
+        uint32_t dedicatedCount = 0;
+        uint32_t allocationCount = 0;
+        // device memory held by blocks and dedicated allocations
+        VkDeviceSize reservedBytes = 0;
+        VkDeviceSize peakReservedBytes = 0;
+        // handed out, including the rounding up to buddy sizes
+        VkDeviceSize allocatedBytes = 0;
+        VkDeviceSize peakAllocatedBytes = 0;
+        // what the resources asked for
+        VkDeviceSize requestedBytes = 0;
+
+        std::array<CategoryStats, static_cast<size_t>(MemoryCategory::COUNT)> categories;
+        std::vector<MemoryTypeStats> memoryTypes;
+        std::vector<HeapStats> heaps;
+        // heap budgets and usage were filled in
+        bool budgetAvailable = false;
+
+        // One line JSON object, for dumps a script can diff over a run
+        std::string ToJson() const;
+    };
+
+    // memoryBudget when VK_EXT_memory_budget is enabled on device
+    MemoryAllocator(VkDevice device,
+                    VkPhysicalDevice physicalDevice,
+                    const VkPhysicalDeviceProperties& properties,
+                    bool memoryBudget);
+    // Frees everything and logs allocations that were never freed
+    ~MemoryAllocator();
+
+    MemoryAllocator(const MemoryAllocator &) = delete;
+    MemoryAllocator &operator=(const MemoryAllocator &) = delete;
+
+    // Memory for the resource, which the caller binds at allocation.offset.
+    // category is what the statistics and the leak report file it under.
+    // Throws when out of memory
+    Allocation AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags properties, MemoryCategory category);
+    Allocation AllocateForImage(VkImage image,
+                                VkImageTiling tiling,
+                                VkMemoryPropertyFlags properties,
+                                MemoryCategory category);
+
+    // After the resource bound to it has been destroyed
+    void Free(const Allocation& allocation);
+
+    // Snapshot of the counters, queries the heap budgets when available
+    Stats GetStats() const;
+
+private:
+    // memory blocks never exceed this, heaps are split into at least 8
+    static constexpr uint32_t MAX_BLOCK_ORDER = 26;
+    static constexpr uint32_t MIN_BLOCK_ORDER = 20;
+    // smallest piece handed out, keeps the free lists short
+    static constexpr uint32_t MIN_ORDER = 8;
+
+    struct LiveAllocation {
+        VkDeviceSize size;
+        MemoryCategory category;
+        uint32_t memoryType;
+        bool dedicated;
+    };
+
+    Allocation Allocate(const VkMemoryRequirements& requirements,
+                        bool dedicatedPreferred,
+                        bool optimalTiling,
+                        VkMemoryPropertyFlags properties,
+                        const VkMemoryDedicatedAllocateInfo& dedicatedInfo,
+                        MemoryCategory category);
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    // allocates and maps host visible memory
+    VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, const void *next, void **mapped);
+    Block *CreateBlock(uint32_t memoryType, bool optimalTiling);
+    // device memory counters, called with mMutex held
+    void AddReserved(uint32_t memoryType, VkDeviceSize size);
+    void RemoveReserved(uint32_t memoryType, VkDeviceSize size);
+
+    VkDevice mDevice;
+    VkPhysicalDevice mPhysicalDevice;
+    bool mMemoryBudget;
+    VkPhysicalDeviceMemoryProperties mMemoryProperties;
+    VkDeviceSize mNonCoherentAtomSize;
+
+    // per memory type and tiling, index memoryType * 2 + optimalTiling
+    std::vector<std::vector<std::unique_ptr<Block>>> mPools;
+    std::vector<uint32_t> mBlockOrders;
+
+    std::map<std::pair<VkDeviceMemory, VkDeviceSize>, LiveAllocation> mLive;
+    Stats mStats;
+
+    mutable std::mutex mMutex;
+};
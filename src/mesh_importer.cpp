@@ -0,0 +1,189 @@
+#include <mesh_importer.hpp>
+#include <mesh_optimizer.hpp>
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct VertexHash {
+    size_t operator()(const Model::Vertex& vertex) const {
+        const float values[] = {vertex.position.x, vertex.position.y,
+                                vertex.color.r, vertex.color.g, vertex.color.b,
+                                vertex.texCoord.x, vertex.texCoord.y};
+
+        size_t hash = 0;
+        for (float value : values) {
+            hash ^= std::hash<float>{}(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        }
+
+        return hash;
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const Model::Vertex& a, const Model::Vertex& b) const {
+        return a.position == b.position && a.color == b.color && a.texCoord == b.texCoord;
+    }
+};
+
+struct ObjPosition {
+    glm::vec2 position;
+    glm::vec3 color;
+};
+
+// OBJ indices are 1 based, negative ones count back from the last element
+size_t ResolveIndex(const std::string& text, size_t count, const std::string& filePath) {
+    long index;
+
+    try {
+        index = std::stol(text);
+    } catch (const std::logic_error&) {
+        throw std::runtime_error(filePath + ": malformed face index \"" + text + "\"");
+    }
+
+    long resolved = index < 0 ? static_cast<long>(count) + index : index - 1;
+
+    if (index == 0 || resolved < 0 || resolved >= static_cast<long>(count)) {
+        throw std::runtime_error(filePath + ": face index " + std::to_string(index) + " out of range");
+    }
+
+    return static_cast<size_t>(resolved);
+}
+
+Model::Builder LoadObj(const std::string& filePath, MeshImporter::Stats& stats) {
+    std::ifstream file(filePath);
+
+    if (!file) {
+        throw std::runtime_error("failed to open mesh " + filePath);
+    }
+
+    std::vector<ObjPosition> positions;
+    std::vector<glm::vec2> texCoords;
+
+    Model::Builder builder;
+    std::unordered_map<Model::Vertex, uint32_t, VertexHash, VertexEqual> vertexIds;
+
+    std::string line;
+    std::vector<uint32_t> face;
+
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+
+        if (keyword == "v") {
+            ObjPosition position{glm::vec2(0.0f), glm::vec3(1.0f)};
+            float z;
+            stream >> position.position.x >> position.position.y >> z;
+
+            if (!stream) {
+                throw std::runtime_error(filePath + ": malformed vertex \"" + line + "\"");
+            }
+
+            // the vertex color extension, white without it
+            glm::vec3 color;
+            if (stream >> color.r >> color.g >> color.b) {
+                position.color = color;
+            }
+
+            positions.push_back(position);
+        } else if (keyword == "vt") {
+            glm::vec2 texCoord;
+            stream >> texCoord.x >> texCoord.y;
+
+            if (!stream) {
+                throw std::runtime_error(filePath + ": malformed texture coordinate \"" + line + "\"");
+            }
+
+            // OBJ puts v = 0 at the bottom of the image, Vulkan at the top
+            texCoords.push_back(glm::vec2(texCoord.x, 1.0f - texCoord.y));
+        } else if (keyword == "f") {
+            face.clear();
+            std::string corner;
+
+            while (stream >> corner) {
+                // v, v/vt, v//vn or v/vt/vn, normals are not used
+                size_t slash = corner.find('/');
+                Model::Vertex vertex{};
+
+                const ObjPosition& position = positions[ResolveIndex(corner.substr(0, slash),
+                                                                     positions.size(), filePath)];
+                vertex.position = position.position;
+                vertex.color = position.color;
+
+                if (slash != std::string::npos && slash + 1 < corner.size() && corner[slash + 1] != '/') {
+                    vertex.texCoord = texCoords[ResolveIndex(corner.substr(slash + 1),
+                                                             texCoords.size(), filePath)];
+                }
+
+                auto [it, inserted] = vertexIds.try_emplace(vertex, static_cast<uint32_t>(builder.vertices.size()));
+                if (inserted) {
+                    builder.vertices.push_back(vertex);
+                }
+
+                face.push_back(it->second);
+                stats.corners++;
+            }
+
+            if (face.size() < 3) {
+                throw std::runtime_error(filePath + ": face with fewer than 3 corners");
+            }
+
+            for (size_t i = 1; i + 1 < face.size(); i++) {
+                builder.indices.insert(builder.indices.end(), {face[0], face[i], face[i + 1]});
+            }
+        }
+    }
+
+    return builder;
+}
+
+}
+
+namespace MeshImporter {
+
+Model::Builder Load(const std::string& filePath, Stats *stats) {
+    std::string extension = std::filesystem::path(filePath).extension().string();
+
+    if (extension != ".obj") {
+        throw std::runtime_error("unsupported mesh format " + filePath);
+    }
+
+    Stats result;
+    Model::Builder builder = LoadObj(filePath, result);
+
+    if (builder.indices.empty()) {
+        throw std::runtime_error(filePath + ": no faces");
+    }
+
+    size_t vertexCount = builder.vertices.size();
+    result.acmrBefore = MeshOptimizer::Acmr(builder.indices, vertexCount);
+
+    MeshOptimizer::OptimizeVertexCache(builder.indices, vertexCount);
+    std::vector<uint32_t> remap = MeshOptimizer::OptimizeVertexFetch(builder.indices, vertexCount);
+
+    std::vector<Model::Vertex> vertices(vertexCount);
+    for (size_t i = 0; i < vertexCount; i++) {
+        vertices[remap[i]] = builder.vertices[i];
+    }
+    builder.vertices.swap(vertices);
+
+    result.acmrAfter = MeshOptimizer::Acmr(builder.indices, vertexCount);
+    result.vertices = vertexCount;
+    result.triangles = builder.indices.size() / 3;
+
+    if (stats) {
+        *stats = result;
+    }
+
+    return builder;
+}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <model.hpp>
+
+// std
+#include <cstddef>
+#include <string>
+
+// Builds models from mesh files. Corners that end up as identical vertices
+// are merged through a hash map, then triangles are reordered for the
+// post-transform vertex cache and vertices for fetch locality, see
+// MeshOptimizer. Only the x and y of positions are kept, the renderer is 2D.
+namespace MeshImporter {
+
+struct Stats {
+    // face corners read from the file, one vertex each before merging
+    size_t corners = 0;
+    size_t vertices = 0;
+    size_t triangles = 0;
+    // see MeshOptimizer::Acmr
+    float acmrBefore = 0.0f;
+    float acmrAfter = 0.0f;
+};
+
+// Wavefront OBJ with positions, optional per vertex colors (v x y z r g b)
+// and texture coordinates. Polygons are triangulated as fans, everything
+// else in the file is ignored. Throws std::runtime_error on malformed files
+Model::Builder Load(const std::string& filePath, Stats *stats = nullptr);
+
+}
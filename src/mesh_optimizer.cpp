@@ -0,0 +1,249 @@
+#include <mesh_optimizer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+// Forsyth's tuning, the modelled cache is larger than the one the ACMR
+// simulation assumes so the order stays good on bigger caches too
+constexpr int CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+// valences above this share the same boost
+constexpr uint32_t MAX_VALENCE = 32;
+
+struct ScoreTables {
+    std::array<float, CACHE_SIZE> cache;
+    std::array<float, MAX_VALENCE + 1> valence;
+};
+
+const ScoreTables& GetScoreTables() {
+    static const ScoreTables tables = []() {
+        ScoreTables values{};
+
+        for (int i = 0; i < CACHE_SIZE; i++) {
+            // the last triangle's vertices score the same no matter the
+            // order, it is about to be emitted anyway
+            if (i < 3) {
+                values.cache[i] = LAST_TRIANGLE_SCORE;
+            } else {
+                float scale = 1.0f / (CACHE_SIZE - 3);
+                values.cache[i] = std::pow(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+            }
+        }
+
+        for (uint32_t i = 1; i <= MAX_VALENCE; i++) {
+            values.valence[i] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -VALENCE_BOOST_POWER);
+        }
+
+        return values;
+    }();
+
+    return tables;
+}
+
+// Vertices with few remaining triangles score higher, so lone triangles are
+// not left behind to be picked up with a cold cache later
+float VertexScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+
+    const ScoreTables& tables = GetScoreTables();
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+
+    return score + tables.valence[std::min(remainingTriangles, MAX_VALENCE)];
+}
+
+}
+
+namespace MeshOptimizer {
+
+float Acmr(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+
+    if (triangleCount == 0) {
+        return 0.0f;
+    }
+
+    // time each vertex entered the cache, a FIFO evicts by age
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t misses = 0;
+
+    for (uint32_t index : indices) {
+        if (insertedAt[index] == 0 || misses - insertedAt[index] >= cacheSize) {
+            misses++;
+            insertedAt[index] = misses;
+        }
+    }
+
+    return static_cast<float>(misses) / triangleCount;
+}
+
+void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount) {
+    size_t triangleCount = indices.size() / 3;
+
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // triangles of each vertex, packed by vertex
+    std::vector<uint32_t> remaining(vertexCount, 0);
+
+    for (uint32_t index : indices) {
+        remaining[index]++;
+    }
+
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        firstTriangle[i + 1] = firstTriangle[i] + remaining[i];
+    }
+
+    std::vector<uint32_t> vertexTriangles(indices.size());
+    std::vector<uint32_t> filled(vertexCount, 0);
+
+    for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+        for (size_t corner = 0; corner < 3; corner++) {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            vertexTriangles[firstTriangle[vertex] + filled[vertex]++] = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+
+    for (size_t i = 0; i < vertexCount; i++) {
+        vertexScore[i] = VertexScore(-1, remaining[i]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+
+    for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+        triangleScore[triangle] = vertexScore[indices[triangle * 3]] +
+                                  vertexScore[indices[triangle * 3 + 1]] +
+                                  vertexScore[indices[triangle * 3 + 2]];
+    }
+
+    // LRU order, with room for the three vertices pushed before trimming
+    std::vector<uint32_t> cache;
+    cache.reserve(CACHE_SIZE + 3);
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    size_t scanPosition = 0;
+    size_t bestTriangle = 0;
+
+    for (size_t triangle = 1; triangle < triangleCount; triangle++) {
+        if (triangleScore[triangle] > triangleScore[bestTriangle]) {
+            bestTriangle = triangle;
+        }
+    }
+
+    while (true) {
+        emitted[bestTriangle] = true;
+
+        std::array<uint32_t, 3> corners{indices[bestTriangle * 3],
+                                        indices[bestTriangle * 3 + 1],
+                                        indices[bestTriangle * 3 + 2]};
+
+        for (uint32_t vertex : corners) {
+            result.push_back(vertex);
+
+            // drop the emitted triangle from the vertex's list
+            uint32_t *begin = vertexTriangles.data() + firstTriangle[vertex];
+            uint32_t *end = begin + remaining[vertex];
+            *std::find(begin, end, static_cast<uint32_t>(bestTriangle)) = *(end - 1);
+            remaining[vertex]--;
+
+            auto it = std::find(cache.begin(), cache.end(), vertex);
+            if (it != cache.end()) {
+                cache.erase(it);
+            }
+        }
+
+        cache.insert(cache.begin(), corners.begin(), corners.end());
+
+        // rescore everything that was in the cache, including vertices that
+        // just fell out of it
+        for (size_t i = 0; i < cache.size(); i++) {
+            uint32_t vertex = cache[i];
+            int position = i < CACHE_SIZE ? static_cast<int>(i) : -1;
+
+            cachePosition[vertex] = position;
+            float delta = VertexScore(position, remaining[vertex]) - vertexScore[vertex];
+            vertexScore[vertex] += delta;
+
+            for (uint32_t j = 0; j < remaining[vertex]; j++) {
+                triangleScore[vertexTriangles[firstTriangle[vertex] + j]] += delta;
+            }
+        }
+
+        if (cache.size() > CACHE_SIZE) {
+            cache.resize(CACHE_SIZE);
+        }
+
+        // the best next triangle almost always touches the cache
+        float bestScore = -1.0f;
+
+        for (uint32_t vertex : cache) {
+            for (uint32_t j = 0; j < remaining[vertex]; j++) {
+                uint32_t triangle = vertexTriangles[firstTriangle[vertex] + j];
+
+                if (triangleScore[triangle] > bestScore) {
+                    bestScore = triangleScore[triangle];
+                    bestTriangle = triangle;
+                }
+            }
+        }
+
+        if (bestScore >= 0.0f) {
+            continue;
+        }
+
+        // the cache ran dry, continue with the next triangle in input order
+        while (scanPosition < triangleCount && emitted[scanPosition]) {
+            scanPosition++;
+        }
+
+        if (scanPosition == triangleCount) {
+            break;
+        }
+
+        bestTriangle = scanPosition;
+    }
+
+    indices.swap(result);
+}
+
+std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount) {
+    constexpr uint32_t UNASSIGNED = ~0u;
+
+    std::vector<uint32_t> remap(vertexCount, UNASSIGNED);
+    uint32_t next = 0;
+
+    for (uint32_t &index : indices) {
+        if (remap[index] == UNASSIGNED) {
+            remap[index] = next++;
+        }
+
+        index = remap[index];
+    }
+
+    for (uint32_t &target : remap) {
+        if (target == UNASSIGNED) {
+            target = next++;
+        }
+    }
+
+    return remap;
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reorders indexed triangle lists for the GPU. Works on indices only, so it
+// is independent of the vertex layout and can run in tools and on loader
+// threads; vertex reordering is returned as a remap table for the caller to
+// apply.
+namespace MeshOptimizer {
+
+// Average cache miss ratio, transformed vertices per triangle, simulating a
+// FIFO post-transform cache of cacheSize entries. 3 is the worst case, 0.5
+// is about the best a regular grid can get
+float Acmr(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+// Reorders triangles with Forsyth's linear-speed algorithm so triangles
+// sharing vertices are drawn close together. The triangles themselves and
+// their winding stay the same
+void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+
+// Renumbers vertices in the order the indices first reference them, so the
+// vertex fetch walks memory mostly forward. Rewrites indices in place and
+// returns remap with remap[old] = new; unreferenced vertices go last
+std::vector<uint32_t> OptimizeVertexFetch(std::vector<uint32_t> &indices, size_t vertexCount);
+
+}
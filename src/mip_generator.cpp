@@ -0,0 +1,163 @@
+#include <mip_generator.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// resolution of the linear to sRGB table, fine enough to round trip 8 bits
+constexpr uint32_t LINEAR_STEPS = 4096;
+
+const std::array<float, 256>& SrgbToLinearTable() {
+    static const std::array<float, 256> table = []() {
+        std::array<float, 256> values{};
+
+        for (uint32_t i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        return values;
+    }();
+
+    return table;
+}
+
+const std::array<unsigned char, LINEAR_STEPS>& LinearToSrgbTable() {
+    static const std::array<unsigned char, LINEAR_STEPS> table = []() {
+        std::array<unsigned char, LINEAR_STEPS> values{};
+
+        for (uint32_t i = 0; i < LINEAR_STEPS; i++) {
+            float c = i / static_cast<float>(LINEAR_STEPS - 1);
+            float srgb = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            values[i] = static_cast<unsigned char>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+
+        return values;
+    }();
+
+    return table;
+}
+
+}
+
+namespace MipGenerator {
+
+uint32_t MipLevelCount(uint32_t width, uint32_t height) {
+    uint32_t levels = 1;
+
+    while (width > 1 || height > 1) {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        levels++;
+    }
+
+    return levels;
+}
+
+void DownsampleSrgbRgba8(const unsigned char *src, uint32_t width, uint32_t height, unsigned char *dst) {
+    const auto& toLinear = SrgbToLinearTable();
+    const auto& toSrgb = LinearToSrgbTable();
+
+    uint32_t dstWidth = std::max(1u, width / 2);
+    uint32_t dstHeight = std::max(1u, height / 2);
+
+    // averaging four texels and scaling to a table index in one multiply
+    constexpr float SCALE = 0.25f * (LINEAR_STEPS - 1);
+
+    // both source rows in linear space, 1 pixel wide levels repeat their
+    // column so every destination pixel reads two
+    uint32_t linearWidth = std::max(2u, width);
+    std::vector<float> linear0(static_cast<size_t>(linearWidth) * 4);
+    std::vector<float> linear1(static_cast<size_t>(linearWidth) * 4);
+    std::vector<int32_t> index(static_cast<size_t>(dstWidth) * 4);
+
+    auto linearize = [&](const unsigned char *row, float *out) {
+        // SSE2 has no gather, the table is looked up a channel at a time
+        for (uint32_t x = 0; x < width; x++) {
+            out[x * 4 + 0] = toLinear[row[x * 4 + 0]];
+            out[x * 4 + 1] = toLinear[row[x * 4 + 1]];
+            out[x * 4 + 2] = toLinear[row[x * 4 + 2]];
+            out[x * 4 + 3] = row[x * 4 + 3] / 255.0f;
+        }
+
+        if (width == 1) {
+            std::copy(out, out + 4, out + 4);
+        }
+    };
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        // odd sizes and 1 pixel high levels reuse the last row
+        const unsigned char *row0 = src + static_cast<size_t>(std::min(y * 2, height - 1)) * width * 4;
+        const unsigned char *row1 = src + static_cast<size_t>(std::min(y * 2 + 1, height - 1)) * width * 4;
+
+        linearize(row0, linear0.data());
+
+        if (row1 == row0) {
+            linear1 = linear0;
+        } else {
+            linearize(row1, linear1.data());
+        }
+
+        const float *top = linear0.data();
+        const float *bottom = linear1.data();
+        uint32_t x = 0;
+
+#if defined(__SSE2__)
+        // one pixel per register, all four channels at once, four
+        // destination pixels per iteration
+        const __m128 scale = _mm_set1_ps(SCALE);
+
+        auto filter = [&](uint32_t pixel) {
+            const float *a = top + pixel * 8;
+            const float *b = bottom + pixel * 8;
+
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(a + 4)),
+                                    _mm_add_ps(_mm_loadu_ps(b), _mm_loadu_ps(b + 4)));
+            return _mm_cvtps_epi32(_mm_mul_ps(sum, scale));
+        };
+
+        for (; x + 4 <= dstWidth; x += 4) {
+            __m128i i0 = filter(x);
+            __m128i i1 = filter(x + 1);
+            __m128i i2 = filter(x + 2);
+            __m128i i3 = filter(x + 3);
+
+            auto *out = reinterpret_cast<__m128i *>(index.data() + x * 4);
+            _mm_storeu_si128(out, i0);
+            _mm_storeu_si128(out + 1, i1);
+            _mm_storeu_si128(out + 2, i2);
+            _mm_storeu_si128(out + 3, i3);
+        }
+
+        for (; x < dstWidth; x++) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(index.data() + x * 4), filter(x));
+        }
+#else
+        for (; x < dstWidth; x++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                float sum = top[x * 8 + c] + top[x * 8 + 4 + c] + bottom[x * 8 + c] + bottom[x * 8 + 4 + c];
+                index[x * 4 + c] = static_cast<int32_t>(sum * SCALE + 0.5f);
+            }
+        }
+#endif
+
+        unsigned char *out = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+        for (uint32_t i = 0; i < dstWidth; i++) {
+            out[i * 4 + 0] = toSrgb[index[i * 4 + 0]];
+            out[i * 4 + 1] = toSrgb[index[i * 4 + 1]];
+            out[i * 4 + 2] = toSrgb[index[i * 4 + 2]];
+            out[i * 4 + 3] = static_cast<unsigned char>((index[i * 4 + 3] * 255 + (LINEAR_STEPS - 1) / 2) /
+                                                        (LINEAR_STEPS - 1));
+        }
+    }
+}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// CPU fallback for building mip chains when the GPU cannot blit a format
+// with linear filtering. Independent of Vulkan so it can run on loader
+// threads and in offline tools.
+namespace MipGenerator {
+
+// Number of levels in a full chain down to 1x1
+uint32_t MipLevelCount(uint32_t width, uint32_t height);
+
+// Halves an sRGB encoded RGBA8 image with a 2x2 box filter. Colors are
+// averaged in linear space like a linear filtered blit would, alpha is
+// averaged as is. dst must hold max(1, width / 2) * max(1, height / 2)
+// pixels.
+void DownsampleSrgbRgba8(const unsigned char *src, uint32_t width, uint32_t height, unsigned char *dst);
+
+}
@@ -1,21 +1,30 @@
 #include <model.hpp>
 #include <cstring>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtc/packing.hpp>
 
 #include "core/coordinator.hpp"
 
 extern Coordinator gCoordinator;
 
-Model::Model(std::shared_ptr<Device> device, const Builder& builder) :
-             mDevice(device) {
-    CreateVertexBuffer(builder.vertices);
-    CreateIndexBuffer(builder.indices);
+Model::Model(GeometryPool& geometryPool, const Builder& builder, UploadManager& uploadManager) :
+             mGeometryPool(geometryPool) {
+    VertexFormat format = builder.vertexFormat;
+
+    if (format == VertexFormat::COMPACT && !FitsCompact(builder.vertices)) {
+        gCoordinator.LogDebug("model positions exceed [-1, 1], keeping float vertices");
+        format = VertexFormat::FLOAT;
+    }
 
-    // device pointer no longer needed
-    mDevice = nullptr;
+    CreateVertexBuffer(builder.vertices, format, uploadManager);
+    CreateIndexBuffer(builder.indices, uploadManager);
 }
 
 Model::~Model() {
-
+    mGeometryPool.FreeVertices(mVertices);
+    mGeometryPool.FreeIndices(mIndices);
 }
 
 std::vector<VkVertexInputBindingDescription> Model::Vertex::GetBindingDescriptions() {
@@ -47,81 +56,130 @@ std::vector<VkVertexInputAttributeDescription> Model::Vertex::GetAttributeDescri
     return attributeDescriptions;
 }
 
-void Model::Bind(VkCommandBuffer commandBuffer) {
-    VkBuffer buffers[] = {mVertexBuffer->GetBuffer()};
-    VkDeviceSize offsets[] = {0};
+std::vector<VkVertexInputBindingDescription> Model::CompactVertex::GetBindingDescriptions() {
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding = 0;
+    bindingDescriptions[0].stride = sizeof(Model::CompactVertex);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> Model::CompactVertex::GetAttributeDescriptions() {
+    // normalized and half formats reach the shader as floats, a vec3 input
+    // reads the first three channels of the color
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(3);
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R16G16_SNORM;
+    attributeDescriptions[0].offset = offsetof(Model::CompactVertex, position);
+
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[1].offset = offsetof(Model::CompactVertex, color);
+
+    attributeDescriptions[2].binding = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+    attributeDescriptions[2].offset = offsetof(Model::CompactVertex, texCoord);
+
+    return attributeDescriptions;
+}
+
+std::vector<VkVertexInputBindingDescription> Model::GetBindingDescriptions(VertexFormat format) {
+    return format == VertexFormat::COMPACT ? CompactVertex::GetBindingDescriptions()
+                                           : Vertex::GetBindingDescriptions();
+}
+
+std::vector<VkVertexInputAttributeDescription> Model::GetAttributeDescriptions(VertexFormat format) {
+    return format == VertexFormat::COMPACT ? CompactVertex::GetAttributeDescriptions()
+                                           : Vertex::GetAttributeDescriptions();
+}
 
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+bool Model::FitsCompact(const std::vector<Vertex>& vertices) {
+    for (const auto& vertex : vertices) {
+        if (std::abs(vertex.position.x) > 1.0f || std::abs(vertex.position.y) > 1.0f) {
+            return false;
+        }
+    }
 
-    // index size can be optimized
-    vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+    return true;
 }
 
-void Model::Draw(VkCommandBuffer commandBuffer) {
-    vkCmdDrawIndexed(commandBuffer, mIndexCount, 1, 0, 0, 0);
+void Model::Bind(VkCommandBuffer commandBuffer) {
+    mGeometryPool.Bind(commandBuffer, mIndexType);
+}
+
+void Model::Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) {
+    VkDrawIndexedIndirectCommand command = GetDrawCommand();
+    vkCmdDrawIndexed(commandBuffer,
+                     command.indexCount,
+                     instanceCount,
+                     command.firstIndex,
+                     command.vertexOffset,
+                     firstInstance);
 }
 
-void Model::CreateVertexBuffer(const std::vector<Vertex>& vertices) {
+VkDrawIndexedIndirectCommand Model::GetDrawCommand() const {
+    // ranges start at a multiple of their element size
+    VkDeviceSize vertexSize = mVertexFormat == VertexFormat::COMPACT ? sizeof(CompactVertex) : sizeof(Vertex);
+    VkDeviceSize indexSize = mIndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    VkDrawIndexedIndirectCommand command{};
+    command.indexCount = mIndexCount;
+    command.instanceCount = 1;
+    command.firstIndex = static_cast<uint32_t>(mIndices.offset / indexSize);
+    command.vertexOffset = static_cast<int32_t>(mVertices.offset / vertexSize);
+    command.firstInstance = 0;
+
+    return command;
+}
+
+void Model::CreateVertexBuffer(const std::vector<Vertex>& vertices, VertexFormat format, UploadManager& uploadManager) {
     mVertexCount = static_cast<uint32_t>(vertices.size());
+    mVertexFormat = format;
     gCoordinator.Assert(mVertexCount >= 3, "Vertex count must be at least 3");
 
-    VkDeviceSize bufferSize = sizeof(vertices[0]) * mVertexCount;
-    uint32_t vertexSize = sizeof(vertices[0]);
-
-    // create staging buffer
-    Buffer stagingBuffer(
-        mDevice,
-        vertexSize,
-        mVertexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    );
-
-    // copy data to staging buffer
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer((void *)vertices.data());
-
-    // create vertex buffer
-    mVertexBuffer = std::make_unique<Buffer>(
-        mDevice,
-        vertexSize,
-        mVertexCount,
-        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-    );
-
-    // copy data from staging to vertex buffer
-    mDevice->CopyBuffer(stagingBuffer.GetBuffer(), mVertexBuffer->GetBuffer(), bufferSize);
+    if (format == VertexFormat::COMPACT) {
+        std::vector<CompactVertex> compactVertices(mVertexCount);
+
+        for (uint32_t i = 0; i < mVertexCount; i++) {
+            const Vertex& vertex = vertices[i];
+            CompactVertex& compact = compactVertices[i];
+
+            compact.position[0] = static_cast<int16_t>(glm::packSnorm1x16(vertex.position.x));
+            compact.position[1] = static_cast<int16_t>(glm::packSnorm1x16(vertex.position.y));
+            compact.color[0] = glm::packUnorm1x8(vertex.color.r);
+            compact.color[1] = glm::packUnorm1x8(vertex.color.g);
+            compact.color[2] = glm::packUnorm1x8(vertex.color.b);
+            compact.color[3] = 255;
+            compact.texCoord[0] = glm::packHalf1x16(vertex.texCoord.x);
+            compact.texCoord[1] = glm::packHalf1x16(vertex.texCoord.y);
+        }
+
+        mVertices = mGeometryPool.AllocateVertices(compactVertices.data(), sizeof(CompactVertex) * mVertexCount,
+                                                   sizeof(CompactVertex), uploadManager);
+        return;
+    }
+
+    mVertices = mGeometryPool.AllocateVertices(vertices.data(), sizeof(vertices[0]) * mVertexCount,
+                                               sizeof(vertices[0]), uploadManager);
 }
 
-void Model::CreateIndexBuffer(const std::vector<uint32_t>& indices) {
+void Model::CreateIndexBuffer(const std::vector<uint32_t>& indices, UploadManager& uploadManager) {
     mIndexCount = static_cast<uint32_t>(indices.size());
 
-    VkDeviceSize bufferSize = sizeof(indices[0]) * mIndexCount;
-    uint32_t indexSize = sizeof(indices[0]);
-
-    // create staging buffer
-    Buffer stagingBuffer(
-        mDevice,
-        indexSize,
-        mIndexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-    );
-
-    // copy data to staging buffer
-    stagingBuffer.Map();
-    stagingBuffer.WriteToBuffer((void *)indices.data());
-
-    // create index buffer
-    mIndexBuffer = std::make_unique<Buffer>(
-        mDevice,
-        indexSize,
-        mIndexCount,
-        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
-    );
-
-    // copy data from staging to index buffer
-    mDevice->CopyBuffer(stagingBuffer.GetBuffer(), mIndexBuffer->GetBuffer(), bufferSize);
+    // every index is below the vertex count
+    if (mVertexCount <= std::numeric_limits<uint16_t>::max() + 1u) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        mIndexType = VK_INDEX_TYPE_UINT16;
+
+        mIndices = mGeometryPool.AllocateIndices(shortIndices.data(), sizeof(uint16_t) * mIndexCount,
+                                                 sizeof(uint16_t), uploadManager);
+        return;
+    }
+
+    mIndices = mGeometryPool.AllocateIndices(indices.data(), sizeof(indices[0]) * mIndexCount,
+                                             sizeof(indices[0]), uploadManager);
 }
@@ -3,6 +3,8 @@
 #include <memory>
 #include <device.hpp>
 #include <buffer.hpp>
+#include <geometry_pool.hpp>
+#include <upload_manager.hpp>
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -12,6 +14,16 @@
 
 class Model {
 public:
+    // Layout of the vertex buffer, each needs its own pipeline
+    enum class VertexFormat {
+        // Vertex as is
+        FLOAT,
+        // CompactVertex, positions must lie within [-1, 1]
+        COMPACT
+    };
+
+    static constexpr size_t VERTEX_FORMAT_COUNT = 2;
+
     struct Vertex {
         alignas(8) glm::vec2 position;
         alignas(16) glm::vec3 color;
@@ -21,27 +33,71 @@ public:
         static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
     };
 
+    // Vertex packed into 12 bytes instead of 48, read by the same shaders:
+    // snorm16 position, unorm8 color and half float texture coordinates
+    struct CompactVertex {
+        int16_t position[2];
+        uint8_t color[4];
+        uint16_t texCoord[2];
+
+        static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+        static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+    };
+
     struct Builder {
         std::vector<Vertex> vertices{};
         std::vector<uint32_t> indices{};
+        // COMPACT falls back to FLOAT when a position does not fit
+        VertexFormat vertexFormat = VertexFormat::FLOAT;
     };
 
-    Model(std::shared_ptr<Device> device, const Builder& builder);
+    static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(VertexFormat format);
+    static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(VertexFormat format);
+
+    // Geometry is copied into ranges of the pool through the upload
+    // manager, the model can be drawn by work submitted after its next Flush.
+    // The ranges are freed with the model
+    Model(GeometryPool& geometryPool, const Builder& builder, UploadManager& uploadManager);
     ~Model();
 
+    // Binds the shared pool buffers, models with the same index type can be
+    // drawn one after another without binding again
     void Bind(VkCommandBuffer commandBuffer);
-    void Draw(VkCommandBuffer commandBuffer);
+    void Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+    VkIndexType GetIndexType() const {
+        return mIndexType;
+    }
+
+    // Arguments drawing this model from the bound pool buffers, for
+    // indirect draws
+    VkDrawIndexedIndirectCommand GetDrawCommand() const;
+
+    // Bind only with a pipeline created for this format
+    VertexFormat GetVertexFormat() const {
+        return mVertexFormat;
+    }
+
+    // Pool memory of the vertex and index ranges
+    VkDeviceSize GetMemorySize() const {
+        return mVertices.size + mIndices.size;
+    }
 
 
 private:
-    void CreateVertexBuffer(const std::vector<Vertex>& vertices);
-    void CreateIndexBuffer(const std::vector<uint32_t>& indices);
+    void CreateVertexBuffer(const std::vector<Vertex>& vertices, VertexFormat format, UploadManager& uploadManager);
+    void CreateIndexBuffer(const std::vector<uint32_t>& indices, UploadManager& uploadManager);
+
+    static bool FitsCompact(const std::vector<Vertex>& vertices);
 
-    std::shared_ptr<Device> mDevice;
+    GeometryPool& mGeometryPool;
 
-    std::unique_ptr<Buffer> mVertexBuffer;
+    GeometryPool::Range mVertices;
     uint32_t mVertexCount;
+    VertexFormat mVertexFormat = VertexFormat::FLOAT;
 
-    std::unique_ptr<Buffer> mIndexBuffer;
+    // 16 bit whenever every vertex can be addressed with it
+    GeometryPool::Range mIndices;
     uint32_t mIndexCount;
+    VkIndexType mIndexType = VK_INDEX_TYPE_UINT32;
 };
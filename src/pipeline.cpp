@@ -96,6 +96,9 @@ void Pipeline::DefaultConfigInfo(Pipeline::ConfigInfo& configInfo) {
     configInfo.dynamicStateInfo.dynamicStateCount =
         static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
     configInfo.dynamicStateInfo.flags = 0;
+
+    configInfo.bindingDescriptions = Model::Vertex::GetBindingDescriptions();
+    configInfo.attributeDescriptions = Model::Vertex::GetAttributeDescriptions();
 }
 
 std::vector<char> Pipeline::ReadFile(const std::string& filePath) {
@@ -146,8 +149,8 @@ void Pipeline::CreatePipeline(const std::string& vertShaderPath,
     shaderStages[1].pNext = nullptr;
     shaderStages[1].pSpecializationInfo = nullptr;
 
-    auto bindingDescriptions = Model::Vertex::GetBindingDescriptions();
-    auto attributeDescriptions = Model::Vertex::GetAttributeDescriptions();
+    const auto& bindingDescriptions = configInfo.bindingDescriptions;
+    const auto& attributeDescriptions = configInfo.attributeDescriptions;
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
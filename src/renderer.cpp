@@ -12,6 +12,8 @@ Renderer::Renderer(std::shared_ptr<Window> window, std::shared_ptr<Device> devic
                    mWindow(window), mDevice(device) {
     RecreateSwapChain();
     CreateCommandBuffers();
+
+    mFrameRing = std::make_unique<FrameRingBuffer>(mDevice);
 }
 
 Renderer::~Renderer() {
@@ -83,6 +85,9 @@ VkCommandBuffer Renderer::BeginFrame() {
     mIsFrameStarted = true;
     auto commandBuffer = GetCurrentCommandBuffer();
 
+    // acquiring waited for the frame's fence, its ring region is free again
+    mFrameRing->BeginFrame(static_cast<uint32_t>(mCurrentFrameIndex));
+
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
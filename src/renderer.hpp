@@ -2,6 +2,7 @@
 
 #include <core/window/window.hpp>
 #include <device.hpp>
+#include <frame_ring_buffer.hpp>
 #include <swap_chain.hpp>
 #include <model.hpp>
 
@@ -34,6 +35,12 @@ public:
         return mCurrentFrameIndex;
     }
 
+    // Transient data of the current frame, see FrameRingBuffer
+    FrameRingBuffer& GetFrameRing() {
+        assert(mIsFrameStarted && "Can't get frame ring if frame is not in progress");
+        return *mFrameRing;
+    }
+
     VkCommandBuffer BeginFrame();
     void EndFrame();
     void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer);
@@ -48,6 +55,7 @@ private:
     std::shared_ptr<Device> mDevice;
     std::unique_ptr<SwapChain> mSwapChain;
     std::vector<VkCommandBuffer> mCommandBuffers;
+    std::unique_ptr<FrameRingBuffer> mFrameRing;
 
     uint32_t mCurrentImageIndex;
     int mCurrentFrameIndex;
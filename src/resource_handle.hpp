@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/event/event_types.hpp"
+
+// Resource names are hashed with the same FNV helper as event ids, so
+// "chicken"_hash can be used wherever a ResourceId is expected.
+using ResourceId = std::uint32_t;
+
+inline ResourceId MakeResourceId(const std::string& name) {
+    return fnv1a_32(name.c_str(), name.size());
+}
+
+// Index into a ResourcePool plus the generation of the slot it was issued
+// for. Removing a resource bumps the slot generation, so stale handles are
+// detected instead of silently resolving to whatever reuses the slot.
+template<typename Tag>
+struct ResourceHandle {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;
+
+    bool IsValid() const {
+        return generation != 0;
+    }
+
+    bool operator==(const ResourceHandle& other) const = default;
+};
+
+class Texture;
+class Model;
+
+using TextureHandle = ResourceHandle<Texture>;
+using ModelHandle = ResourceHandle<Model>;
+
+// Reference counting hooks, implemented by the ResourceManager. Stale and
+// invalid handles are ignored.
+void RetainResource(TextureHandle handle);
+void ReleaseResource(TextureHandle handle);
+void RetainResource(ModelHandle handle);
+void ReleaseResource(ModelHandle handle);
+
+// Handle that keeps its resource referenced for as long as it exists, so
+// components can hold resources without tracking their lifetime by hand.
+// Unreferenced resources become candidates for eviction.
+template<typename Tag>
+class ResourceRef {
+public:
+    using Handle = ResourceHandle<Tag>;
+
+    ResourceRef() = default;
+
+    ResourceRef(Handle handle) : mHandle(handle) {
+        RetainResource(mHandle);
+    }
+
+    ResourceRef(const ResourceRef& other) : mHandle(other.mHandle) {
+        RetainResource(mHandle);
+    }
+
+    ResourceRef(ResourceRef&& other) noexcept : mHandle(other.mHandle) {
+        other.mHandle = Handle{};
+    }
+
+    ~ResourceRef() {
+        ReleaseResource(mHandle);
+    }
+
+    ResourceRef& operator=(const ResourceRef& other) {
+        // retain first, other may be the last reference to the same resource
+        RetainResource(other.mHandle);
+        ReleaseResource(mHandle);
+        mHandle = other.mHandle;
+        return *this;
+    }
+
+    ResourceRef& operator=(ResourceRef&& other) noexcept {
+        if (this != &other) {
+            ReleaseResource(mHandle);
+            mHandle = other.mHandle;
+            other.mHandle = Handle{};
+        }
+
+        return *this;
+    }
+
+    Handle Get() const {
+        return mHandle;
+    }
+
+    operator Handle() const {
+        return mHandle;
+    }
+
+    bool IsValid() const {
+        return mHandle.IsValid();
+    }
+
+private:
+    Handle mHandle;
+};
+
+using TextureRef = ResourceRef<Texture>;
+using ModelRef = ResourceRef<Model>;
+
+// Dense slot array owning resources of type T. Resolving a handle is an
+// array index and a generation compare.
+template<typename T>
+class ResourcePool {
+public:
+    using Handle = ResourceHandle<T>;
+
+    Handle Insert(std::unique_ptr<T> resource) {
+        std::uint32_t index;
+
+        if (!mFreeSlots.empty()) {
+            index = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(mSlots.size());
+            mSlots.emplace_back();
+        }
+
+        mSlots[index].resource = std::move(resource);
+        return Handle{index, mSlots[index].generation};
+    }
+
+    // Hands out a handle before the resource exists, for resources that
+    // finish loading later. The handle does not resolve until Emplace.
+    Handle Reserve() {
+        return Insert(nullptr);
+    }
+
+    void Emplace(Handle handle, std::unique_ptr<T> resource) {
+        assert(IsIssued(handle) && "Emplacing into stale resource handle.");
+        mSlots[handle.index].resource = std::move(resource);
+    }
+
+    // Swaps in a new version of a loaded resource, handles stay valid.
+    // Returns the previous version, which may still be in use by the GPU
+    std::unique_ptr<T> Replace(Handle handle, std::unique_ptr<T> resource) {
+        assert(Contains(handle) && "Replacing stale resource handle.");
+        return std::exchange(mSlots[handle.index].resource, std::move(resource));
+    }
+
+    void Remove(Handle handle) {
+        assert(IsIssued(handle) && "Removing stale resource handle.");
+
+        Slot& slot = mSlots[handle.index];
+        slot.resource.reset();
+
+        // generation 0 is reserved for invalid handles
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+
+        mFreeSlots.push_back(handle.index);
+    }
+
+    bool Contains(Handle handle) const {
+        return IsIssued(handle) && mSlots[handle.index].resource;
+    }
+
+    T *Get(Handle handle) const {
+        assert(Contains(handle) && "Resolving stale resource handle.");
+        return mSlots[handle.index].resource.get();
+    }
+
+private:
+    bool IsIssued(Handle handle) const {
+        return handle.index < mSlots.size() && mSlots[handle.index].generation == handle.generation;
+    }
+
+    struct Slot {
+        std::unique_ptr<T> resource;
+        std::uint32_t generation = 1;
+    };
+
+    std::vector<Slot> mSlots;
+    std::vector<std::uint32_t> mFreeSlots;
+};
@@ -1,58 +1,835 @@
 #include <resource_manager.hpp>
 
+#include "core/coordinator.hpp"
+#include "core/io/xxhash.hpp"
+#include <cooked_texture_format.hpp>
+#include <mesh_importer.hpp>
+#include <swap_chain.hpp>
+
 #include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <stdexcept>
+#include <string>
+#include <utility>
+
+extern Coordinator gCoordinator;
+
+namespace {
+
+// assets/textures/<name>.<ext> is cooked into assets/cooked/<name>.vkft by
+// the CookedTextures target, the blob skips decoding and mip generation
+std::string PreferCooked(const std::string& filePath) {
+    std::filesystem::path source = filePath;
+    std::filesystem::path cooked = source.parent_path().parent_path() / "cooked" / source.stem();
+    cooked += CookedTexture::EXTENSION;
+
+    std::error_code error;
+    return std::filesystem::exists(cooked, error) ? cooked.string() : filePath;
+}
+
+bool ReadFile(const std::string& filePath, std::vector<unsigned char>& contents) {
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+
+    if (!file) {
+        return false;
+    }
+
+    contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+
+    return static_cast<bool>(file.read(reinterpret_cast<char *>(contents.data()),
+                                       static_cast<std::streamsize>(contents.size())));
+}
+
+std::vector<unsigned char> ReadFile(const std::string& filePath) {
+    std::vector<unsigned char> contents;
+
+    if (!ReadFile(filePath, contents)) {
+        throw std::runtime_error("failed to read " + filePath);
+    }
+
+    return contents;
+}
+
+// built by the AssetPack target from the cooked textures
+const std::string ASSET_PACK_PATH = "../assets/assets.pack";
+
+// Update runs before the frame waits for its slot, one extra frame covers
+// the frame recorded right after
+constexpr uint64_t RELEASE_DELAY = SwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+
+}
+
+void RetainResource(TextureHandle handle) {
+    if (ResourceManager *manager = ResourceManager::GetInstance()) {
+        manager->Retain(handle);
+    }
+}
+
+void ReleaseResource(TextureHandle handle) {
+    if (ResourceManager *manager = ResourceManager::GetInstance()) {
+        manager->Release(handle);
+    }
+}
+
+void RetainResource(ModelHandle handle) {
+    if (ResourceManager *manager = ResourceManager::GetInstance()) {
+        manager->Retain(handle);
+    }
+}
+
+void ReleaseResource(ModelHandle handle) {
+    if (ResourceManager *manager = ResourceManager::GetInstance()) {
+        manager->Release(handle);
+    }
+}
+
+ResourceManager::~ResourceManager() {
+    if (sInstance == this) {
+        sInstance = nullptr;
+    }
+}
 
 void ResourceManager::LoadResources() {
-    LoadTexture("chicken", "../assets/textures/chicken.jpg");
-
-    // square model
-    std::vector<Model::Vertex> vertices {
-        {glm::vec2(-0.5f, -0.5f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec2(0.0f, 1.0f)},   // -0.5 -0.5                0.5 -0.5
-        {glm::vec2(0.5f, -0.5f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(1.0f, 1.0f)},    
-        {glm::vec2(0.5f, 0.5f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(1.0f, 0.0f)},
-        {glm::vec2(-0.5f, 0.5f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f)}    // -0.5 0.5                 0.5 0.5
+    std::error_code error;
+
+    if (std::filesystem::exists(ASSET_PACK_PATH, error)) {
+        OpenPack(ASSET_PACK_PATH);
+        LoadPackedTexture("chicken");
+    } else {
+        LoadTextureAsync("chicken", PreferCooked("../assets/textures/chicken.jpg"));
+    }
+
+    LoadModel("square", "../assets/models/square.obj");
+}
+
+TextureHandle ResourceManager::LoadTexture(const std::string& name, const std::string& filePath) {
+    ResourceId id = MakeResourceId(name);
+
+    // check if a texture with the given name has already been loaded
+    if (mTextureIds.contains(id)) {
+        throw std::runtime_error("Texture named " + name + " has already been loaded");
+    }
+
+    std::vector<unsigned char> contents = ReadFile(filePath);
+    uint64_t contentHash = XxHash::Hash64(contents.data(), contents.size());
+
+    if (TextureFuture alias = FindTextureContent(id, contentHash, contents.size()); alias.mState) {
+        return alias.mHandle;
+    }
+
+    Texture::ImageData image = Texture::ImageData::Load(contents, filePath);
+
+    if (mCpuMips) {
+        image.GenerateMips();
+    }
+
+    TextureFuture future;
+    future.mHandle = mTextures.Reserve();
+    future.mState = std::make_shared<TextureFuture::State>();
+
+    mTextureIds[id] = future.mHandle;
+    Track(mTextureUsage, future.mHandle.index, future.mHandle.generation, id, false);
+    TrackTextureContent(future, contentHash);
+    WatchTextureSource(id, filePath);
+    auto texture = std::make_unique<Texture>(mDevice, image, *mUploadManager);
+    mPendingTextures.push_back({future, std::move(texture), mUploadManager->GetOpenBatch()});
+
+    return future.mHandle;
+}
+
+TextureFuture ResourceManager::LoadTextureAsync(const std::string& name, const std::string& filePath) {
+    ResourceId id = MakeResourceId(name);
+
+    // check if a texture with the given name has already been loaded
+    if (mTextureIds.contains(id)) {
+        throw std::runtime_error("Texture named " + name + " has already been loaded");
+    }
+
+    TextureFuture future;
+    future.mHandle = mTextures.Reserve();
+    future.mState = std::make_shared<TextureFuture::State>();
+
+    mTextureIds[id] = future.mHandle;
+    Track(mTextureUsage, future.mHandle.index, future.mHandle.generation, id, false);
+    WatchTextureSource(id, filePath);
+
+    // the file is read and hashed on the worker, Update settles duplicates
+    DecodeTextureAsync(id, future, filePath, false);
+
+    return future;
+}
+
+void ResourceManager::DecodeTextureAsync(ResourceId id,
+                                         TextureFuture future,
+                                         const std::string& filePath,
+                                         bool reload) {
+    mLoaderPool->Submit([this, id, future, filePath, reload, cpuMips = mCpuMips]() {
+        DecodedTexture decoded{id, future, std::nullopt, {}, 0, 0, reload};
+
+        try {
+            // reloads are not deduplicated, their bytes need no hash
+            if (reload) {
+                decoded.image = Texture::ImageData::Load(filePath);
+            } else {
+                std::vector<unsigned char> contents = ReadFile(filePath);
+                decoded.contentHash = XxHash::Hash64(contents.data(), contents.size());
+                decoded.size = contents.size();
+                decoded.image = Texture::ImageData::Load(contents, filePath);
+            }
+
+            if (cpuMips) {
+                decoded.image->GenerateMips();
+            }
+        } catch (const std::exception& e) {
+            decoded.error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(mDecodedMutex);
+        mDecodedTextures.push_back(std::move(decoded));
+    });
+}
+
+void ResourceManager::EnableHotReload() {
+    mWatcher = std::make_unique<FileWatcher>();
+
+    for (const char *directory : {"../assets/textures", "../assets/cooked"}) {
+        if (!mWatcher->Watch(directory)) {
+            gCoordinator.LogInfo("hot reload: cannot watch ", directory);
+        }
+    }
+}
+
+void ResourceManager::WatchTextureSource(ResourceId id, const std::string& filePath) {
+    mTextureSources[std::filesystem::path(filePath).stem().string()] = id;
+}
+
+void ResourceManager::ReloadChangedTextures() {
+    if (!mWatcher) {
+        return;
+    }
+
+    for (const std::string& filePath : mWatcher->TakeChanges()) {
+        auto source = mTextureSources.find(std::filesystem::path(filePath).stem().string());
+
+        if (source == mTextureSources.end()) {
+            continue;
+        }
+
+        // evicted since, the next load reads the new file anyway
+        auto it = mTextureIds.find(source->second);
+
+        if (it == mTextureIds.end()) {
+            mTextureSources.erase(source);
+            continue;
+        }
+
+        gCoordinator.LogInfo("hot reload: ", filePath);
+
+        TextureFuture future;
+        future.mHandle = it->second;
+        future.mState = std::make_shared<TextureFuture::State>();
+
+        DecodeTextureAsync(source->second, future, filePath, true);
+    }
+}
+
+void ResourceManager::Update() {
+    mFrame++;
+
+    ReleaseRetiredResources();
+    PublishUploadedResources();
+    ReloadChangedTextures();
+    UploadDecodedTextures();
+    ResolveAliasedTextures();
+    UploadAtlasPages();
+    EvictToBudget();
+
+    // synchronous loads recorded since the last frame go out with this
+    // batch, unless something else flushed them already
+    mUploadManager->Flush();
+}
+
+void ResourceManager::UploadAtlasPages() {
+    // every page changed since the last frame is uploaded again as a whole,
+    // so sprites inserted in one frame share a single upload per page
+    for (uint32_t page : mAtlas.GetDirtyPages()) {
+        Texture::ImageData layout;
+        layout.width = mAtlas.GetPageSize();
+        layout.height = mAtlas.GetPageSize();
+        layout.levels.push_back({0, layout.width, layout.height});
+        layout.mipmapped = false;
+        // filtering at the page border would pull in texels of the other side
+        layout.sampler.addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+        const unsigned char *pixels = mAtlas.GetPagePixels(page);
+        size_t size = static_cast<size_t>(layout.Size());
+
+        auto texture = std::make_unique<Texture>(mDevice, layout, [pixels, size](void *dst) {
+            std::memcpy(dst, pixels, size);
+        }, *mUploadManager);
+
+        TextureHandle handle = mTextures.Reserve();
+        Track(mTextureUsage, handle.index, handle.generation, 0, true);
+
+        mPendingAtlasPages.push_back({mAtlas.TakeSnapshot(page),
+                                      handle,
+                                      std::move(texture),
+                                      mUploadManager->GetOpenBatch()});
+    }
+}
+
+void ResourceManager::RetireTexture(TextureHandle handle) {
+    ResourceUsage *usage = FindUsage(mTextureUsage, handle.index, handle.generation);
+
+    mUsage.gpuBytes -= usage->memory.gpuBytes;
+    mUsage.cpuBytes -= usage->memory.cpuBytes;
+    usage->retiring = true;
+
+    mRetiredTextures.push_back({handle, mFrame + RELEASE_DELAY});
+}
+
+void ResourceManager::RetireModel(ModelHandle handle) {
+    ResourceUsage *usage = FindUsage(mModelUsage, handle.index, handle.generation);
+
+    mUsage.gpuBytes -= usage->memory.gpuBytes;
+    mUsage.cpuBytes -= usage->memory.cpuBytes;
+    usage->retiring = true;
+
+    mRetiredModels.push_back({handle, mFrame + RELEASE_DELAY});
+}
+
+void ResourceManager::ReleaseRetiredResources() {
+    std::erase_if(mRetiredTextures, [this](const Retired<TextureHandle>& retired) {
+        if (retired.releaseFrame > mFrame) {
+            return false;
+        }
+
+        if (mTextureUsage[retired.handle.index].spareSlot) {
+            mTextureTable->ReleaseSpareSlot(*mTextureUsage[retired.handle.index].spareSlot);
+        }
+
+        mTextureUsage[retired.handle.index] = {};
+        mTextures.Remove(retired.handle);
+        return true;
+    });
+
+    std::erase_if(mReplacedTextures, [this](const ReplacedTexture& replaced) {
+        if (replaced.releaseFrame > mFrame) {
+            return false;
+        }
+
+        if (replaced.spareSlot) {
+            mTextureTable->ReleaseSpareSlot(*replaced.spareSlot);
+        }
+
+        return true;
+    });
+
+    std::erase_if(mRetiredModels, [this](const Retired<ModelHandle>& retired) {
+        if (retired.releaseFrame > mFrame) {
+            return false;
+        }
+
+        mModelUsage[retired.handle.index] = {};
+        mModels.Remove(retired.handle);
+        return true;
+    });
+}
+
+void ResourceManager::EvictToBudget() {
+    auto overBudget = [this]() {
+        return mUsage.gpuBytes > mBudget.gpuBytes || mUsage.cpuBytes > mBudget.cpuBytes;
     };
 
-    std::vector<uint32_t> indices {0, 1, 2, 2, 3, 0};
+    if (!overBudget()) {
+        return;
+    }
+
+    struct Candidate {
+        uint64_t lastUsedFrame;
+        bool texture;
+        uint32_t index;
+    };
+
+    std::vector<Candidate> candidates;
+
+    // only published resources count towards the budget
+    for (uint32_t i = 0; i < mTextureUsage.size(); i++) {
+        const ResourceUsage& usage = mTextureUsage[i];
+
+        if (usage.generation != 0 && usage.refCount == 0 && !usage.pinned && !usage.retiring &&
+            mTextures.Contains(TextureHandle{i, usage.generation})) {
+            candidates.push_back({usage.lastUsedFrame, true, i});
+        }
+    }
+
+    for (uint32_t i = 0; i < mModelUsage.size(); i++) {
+        const ResourceUsage& usage = mModelUsage[i];
+
+        if (usage.generation != 0 && usage.refCount == 0 && !usage.retiring &&
+            mModels.Contains(ModelHandle{i, usage.generation})) {
+            candidates.push_back({usage.lastUsedFrame, false, i});
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.lastUsedFrame < b.lastUsedFrame;
+    });
+
+    // whatever is still referenced stays resident, even over budget
+    for (const Candidate& candidate : candidates) {
+        if (!overBudget()) {
+            return;
+        }
+
+        // forget the name right away so the next load creates a fresh resource
+        if (candidate.texture) {
+            TextureHandle handle{candidate.index, mTextureUsage[candidate.index].generation};
+            ForgetTexture(handle);
+            RetireTexture(handle);
+        } else {
+            ModelHandle handle{candidate.index, mModelUsage[candidate.index].generation};
+            mModelIds.erase(mModelUsage[candidate.index].id);
+            RetireModel(handle);
+        }
+    }
+}
+
+ResourceManager::ResourceUsage *ResourceManager::FindUsage(std::vector<ResourceUsage>& usages,
+                                                           uint32_t index,
+                                                           uint32_t generation) {
+    if (index >= usages.size() || generation == 0 || usages[index].generation != generation) {
+        return nullptr;
+    }
+
+    return &usages[index];
+}
+
+void ResourceManager::Track(std::vector<ResourceUsage>& usages,
+                            uint32_t index,
+                            uint32_t generation,
+                            ResourceId id,
+                            bool pinned) {
+    if (index >= usages.size()) {
+        usages.resize(index + 1);
+    }
+
+    usages[index] = {};
+    usages[index].generation = generation;
+    usages[index].id = id;
+    usages[index].pinned = pinned;
+}
+
+void ResourceManager::Retain(TextureHandle handle) {
+    if (ResourceUsage *usage = FindUsage(mTextureUsage, handle.index, handle.generation)) {
+        usage->refCount++;
+    }
+}
+
+void ResourceManager::Release(TextureHandle handle) {
+    ResourceUsage *usage = FindUsage(mTextureUsage, handle.index, handle.generation);
+
+    if (usage && --usage->refCount == 0) {
+        usage->lastUsedFrame = mFrame;
+    }
+}
+
+void ResourceManager::Retain(ModelHandle handle) {
+    if (ResourceUsage *usage = FindUsage(mModelUsage, handle.index, handle.generation)) {
+        usage->refCount++;
+    }
+}
+
+void ResourceManager::Release(ModelHandle handle) {
+    ResourceUsage *usage = FindUsage(mModelUsage, handle.index, handle.generation);
+
+    if (usage && --usage->refCount == 0) {
+        usage->lastUsedFrame = mFrame;
+    }
+}
+
+void ResourceManager::UploadDecodedTextures() {
+    std::vector<DecodedTexture> decodedTextures;
+
+    {
+        std::lock_guard<std::mutex> lock(mDecodedMutex);
+        decodedTextures.swap(mDecodedTextures);
+    }
+
+    for (auto& decoded : decodedTextures) {
+        // a broken file keeps the current version on screen
+        if (!decoded.image && decoded.reload) {
+            gCoordinator.LogError(decoded.error);
+            continue;
+        }
+
+        if (!decoded.image) {
+            FailTexture(decoded.future, std::move(decoded.error));
+            continue;
+        }
+
+        // duplicates are only known now that the bytes have been hashed
+        if (decoded.contentHash != 0) {
+            if (AliasDecodedTexture(decoded)) {
+                continue;
+            }
+
+            TrackTextureContent(decoded.future, decoded.contentHash);
+        }
+
+        auto texture = std::make_unique<Texture>(mDevice, *decoded.image, *mUploadManager);
+        mPendingTextures.push_back({decoded.future, std::move(texture), mUploadManager->GetOpenBatch(), decoded.reload});
+    }
+}
+
+bool ResourceManager::AliasDecodedTexture(DecodedTexture& decoded) {
+    TextureFuture target = FindTextureContent(decoded.id, decoded.contentHash, decoded.size);
+
+    if (!target.mState) {
+        return false;
+    }
+
+    // the name resolves to target from here on and follows the file of the
+    // first name on hot reload, the reserved slot is given back
+    std::erase_if(mTextureSources, [&decoded](const auto& entry) {
+        return entry.second == decoded.id;
+    });
+
+    mTextureUsage[decoded.future.mHandle.index] = {};
+    mTextures.Remove(decoded.future.mHandle);
+
+    decoded.future.mState->alias = target.mHandle;
+    mAliasedTextures.push_back({decoded.future, target});
+
+    return true;
+}
+
+void ResourceManager::ResolveAliasedTextures() {
+    std::erase_if(mAliasedTextures, [](const AliasedTexture& aliased) {
+        AssetStatus status = aliased.target.GetStatus();
+
+        if (status == AssetStatus::PENDING) {
+            return false;
+        }
+
+        if (status == AssetStatus::FAILED) {
+            aliased.future.mState->error = aliased.target.GetError();
+        }
+
+        aliased.future.mState->status.store(status, std::memory_order_release);
+        return true;
+    });
+}
+
+void ResourceManager::PublishUploadedResources() {
+    for (auto it = mPendingTextures.begin(); it != mPendingTextures.end();) {
+        if (!mUploadManager->IsComplete(it->batchId)) {
+            ++it;
+            continue;
+        }
+
+        if (it->reload) {
+            ReplaceTexture(it->future.mHandle, std::move(it->texture));
+        } else if (!PublishTexture(it->future.mHandle, std::move(it->texture))) {
+            FailTexture(it->future, "bindless texture table is full");
+            it = mPendingTextures.erase(it);
+            continue;
+        }
+        it->future.mState->status.store(AssetStatus::READY, std::memory_order_release);
+
+        it = mPendingTextures.erase(it);
+    }
+
+    for (auto it = mPendingModels.begin(); it != mPendingModels.end();) {
+        if (!mUploadManager->IsComplete(it->batchId)) {
+            ++it;
+            continue;
+        }
+
+        PublishModel(it->handle, std::move(it->model));
+        it = mPendingModels.erase(it);
+    }
+
+    for (auto it = mPendingAtlasPages.begin(); it != mPendingAtlasPages.end();) {
+        if (!mUploadManager->IsComplete(it->batchId)) {
+            ++it;
+            continue;
+        }
+
+        // the sprites of the snapshot stay unpublished, the current page remains
+        if (!PublishTexture(it->handle, std::move(it->texture))) {
+            gCoordinator.LogError("bindless texture table is full, atlas page dropped");
+            mTextureUsage[it->handle.index] = {};
+            mTextures.Remove(it->handle);
+            it = mPendingAtlasPages.erase(it);
+            continue;
+        }
+
+        TextureHandle previous = mAtlas.Publish(it->snapshot, it->handle);
+
+        if (previous.IsValid()) {
+            RetireTexture(previous);
+        }
+
+        it = mPendingAtlasPages.erase(it);
+    }
+}
+
+bool ResourceManager::PublishTexture(TextureHandle handle, std::unique_ptr<Texture> texture) {
+    if (mTextureTable && !mTextureTable->Write(handle, *texture)) {
+        return false;
+    }
+
+    // pixels only live in staging memory, atlas pages keep theirs in the atlas
+    ResourceUsage& usage = mTextureUsage[handle.index];
+    usage.memory.gpuBytes = texture->GetMemorySize();
+    usage.memory.cpuBytes = sizeof(Texture) + (usage.pinned ? texture->GetMemorySize() : 0);
+    usage.lastUsedFrame = mFrame;
+
+    mUsage.gpuBytes += usage.memory.gpuBytes;
+    mUsage.cpuBytes += usage.memory.cpuBytes;
+
+    mTextures.Emplace(handle, std::move(texture));
+    return true;
+}
+
+void ResourceManager::ReplaceTexture(TextureHandle handle, std::unique_ptr<Texture> texture) {
+    ResourceUsage *usage = FindUsage(mTextureUsage, handle.index, handle.generation);
+
+    // released or still loading the first version, the reload is dropped
+    if (!usage || usage->retiring || !mTextures.Contains(handle)) {
+        return;
+    }
+
+    // the current slot is still sampled by frames in flight
+    std::optional<uint32_t> spareSlot;
+
+    if (mTextureTable) {
+        spareSlot = mTextureTable->AcquireSpareSlot();
 
-    Model::Builder builder{vertices, indices};
+        if (!spareSlot) {
+            gCoordinator.LogError("hot reload: out of spare texture slots");
+            return;
+        }
 
-    LoadModel("square", builder);
+        mTextureTable->Write(*spareSlot, *texture);
+    }
+
+    // the new version no longer matches the bytes it was deduplicated by
+    if (usage->contentHash != 0) {
+        mTextureContents.erase(usage->contentHash);
+        usage->contentHash = 0;
+    }
+
+    mUsage.gpuBytes -= usage->memory.gpuBytes;
+    usage->memory.gpuBytes = texture->GetMemorySize();
+    mUsage.gpuBytes += usage->memory.gpuBytes;
+
+    mReplacedTextures.push_back({mTextures.Replace(handle, std::move(texture)),
+                                 std::exchange(usage->spareSlot, spareSlot),
+                                 mFrame + RELEASE_DELAY});
+}
+
+void ResourceManager::PublishModel(ModelHandle handle, std::unique_ptr<Model> model) {
+    ResourceUsage& usage = mModelUsage[handle.index];
+    usage.memory.gpuBytes = model->GetMemorySize();
+    usage.memory.cpuBytes = sizeof(Model);
+    usage.lastUsedFrame = mFrame;
+
+    mUsage.gpuBytes += usage.memory.gpuBytes;
+    mUsage.cpuBytes += usage.memory.cpuBytes;
+
+    mModels.Emplace(handle, std::move(model));
+}
+
+SpriteHandle ResourceManager::LoadSprite(const std::string& name, const std::string& filePath) {
+    ResourceId id = MakeResourceId(name);
+
+    // check if a sprite with the given name has already been loaded
+    if (mSpriteIds.contains(id)) {
+        throw std::runtime_error("Sprite named " + name + " has already been loaded");
+    }
+
+    std::vector<unsigned char> contents = ReadFile(filePath);
+    uint64_t contentHash = XxHash::Hash64(contents.data(), contents.size());
+
+    // aliased sprites share one region of the atlas
+    if (auto it = mSpriteContents.find(contentHash); it != mSpriteContents.end()) {
+        mSpriteIds[id] = it->second;
+        mDedupStats.aliases++;
+        mDedupStats.bytesSaved += contents.size();
+        return it->second;
+    }
+
+    Texture::ImageData image = Texture::ImageData::Load(contents, filePath);
+
+    // packed at the resolution of the first level, atlas pages have no mips
+    SpriteHandle handle = mAtlas.Insert(image.pixels.get(), image.width, image.height);
+    mSpriteIds[id] = handle;
+    mSpriteContents[contentHash] = handle;
+
+    return handle;
+}
+
+SpriteHandle ResourceManager::FindSprite(ResourceId id) const {
+    auto it = mSpriteIds.find(id);
+
+    if (it == mSpriteIds.end()) {
+        throw std::runtime_error("No sprite with id " + std::to_string(id) + " is loaded");
+    }
+
+    return it->second;
+}
+
+void ResourceManager::OpenPack(const std::string& filePath) {
+    mPack = std::make_unique<AssetPack>(filePath);
 }
 
-void ResourceManager::LoadTexture(const std::string& name, const std::string& filePath) {
+TextureHandle ResourceManager::LoadPackedTexture(const std::string& name) {
+    ResourceId id = MakeResourceId(name);
+
     // check if a texture with the given name has already been loaded
-    if (std::find(mTextureNames.begin(), mTextureNames.end(), name) != mTextureNames.end()) {
+    if (mTextureIds.contains(id)) {
         throw std::runtime_error("Texture named " + name + " has already been loaded");
     }
 
-    mTextureNames.push_back(name);
-    mTextureMap[name] = std::make_unique<Texture>(mDevice, filePath);
+    const PackFormat::Entry *entry = mPack ? mPack->Find(id) : nullptr;
+
+    if (!entry || entry->type != PackFormat::EntryType::COOKED_TEXTURE) {
+        throw std::runtime_error("No texture named " + name + " in asset pack");
+    }
+
+    // header and level table are stored uncompressed in the entry prefix
+    const auto *header = static_cast<const CookedTexture::FileHeader *>(mPack->GetPrefix(*entry));
+    size_t levelsSize = static_cast<size_t>(entry->prefixSize) - sizeof(CookedTexture::FileHeader);
+
+    if (entry->prefixSize < sizeof(CookedTexture::FileHeader) ||
+        levelsSize != header->levelCount * sizeof(CookedTexture::LevelEntry) ||
+        entry->size - entry->prefixSize != header->dataSize) {
+        throw std::runtime_error("Invalid texture " + name + " in asset pack");
+    }
+
+    // the stored bytes are hashed straight from the mapping
+    uint64_t contentHash = XxHash::Hash64(header, entry->prefixSize + entry->storedSize);
+
+    if (TextureFuture alias = FindTextureContent(id, contentHash, entry->size); alias.mState) {
+        return alias.mHandle;
+    }
+
+    Texture::ImageData layout = Texture::ImageData::FromCookedHeader(
+        *header,
+        reinterpret_cast<const CookedTexture::LevelEntry *>(header + 1),
+        mPack->GetPath());
+
+    // pixels go from the mapping into staging memory, no heap copy in between
+    AssetPack *pack = mPack.get();
+    auto texture = std::make_unique<Texture>(mDevice, layout, [pack, entry](void *dst) {
+        pack->ReadPayload(*entry, dst);
+    }, *mUploadManager);
+
+    TextureFuture future;
+    future.mHandle = mTextures.Reserve();
+    future.mState = std::make_shared<TextureFuture::State>();
+
+    mTextureIds[id] = future.mHandle;
+    Track(mTextureUsage, future.mHandle.index, future.mHandle.generation, id, false);
+    TrackTextureContent(future, contentHash);
+    mPendingTextures.push_back({future, std::move(texture), mUploadManager->GetOpenBatch()});
+
+    return future.mHandle;
 }
 
-Texture *ResourceManager::GetTexture(const std::string& name) {
-    if (std::find(mTextureNames.begin(), mTextureNames.end(), name) == mTextureNames.end()) {
-        throw std::runtime_error("No texture named " + name + " is loaded");
+TextureFuture ResourceManager::FindTextureContent(ResourceId id, uint64_t contentHash, size_t size) {
+    auto it = mTextureContents.find(contentHash);
+
+    if (it == mTextureContents.end()) {
+        return {};
     }
 
-    return mTextureMap[name].get();
+    mTextureIds[id] = it->second.mHandle;
+    mDedupStats.aliases++;
+    mDedupStats.bytesSaved += size;
+
+    return it->second;
 }
 
-void ResourceManager::LoadModel(const std::string& name, const Model::Builder& builder) {
+void ResourceManager::TrackTextureContent(TextureFuture future, uint64_t contentHash) {
+    mTextureUsage[future.mHandle.index].contentHash = contentHash;
+    mTextureContents[contentHash] = std::move(future);
+}
+
+void ResourceManager::FailTexture(const TextureFuture& future, std::string error) {
+    gCoordinator.LogError(error);
+
+    ForgetTexture(future.mHandle);
+    mTextureUsage[future.mHandle.index] = {};
+    mTextures.Remove(future.mHandle);
+
+    future.mState->error = std::move(error);
+    future.mState->status.store(AssetStatus::FAILED, std::memory_order_release);
+}
+
+void ResourceManager::ForgetTexture(TextureHandle handle) {
+    std::erase_if(mTextureIds, [handle](const auto& entry) {
+        return entry.second == handle;
+    });
+
+    uint64_t contentHash = mTextureUsage[handle.index].contentHash;
+
+    if (contentHash != 0) {
+        mTextureContents.erase(contentHash);
+    }
+}
+
+TextureHandle ResourceManager::FindTexture(ResourceId id) const {
+    auto it = mTextureIds.find(id);
+
+    if (it == mTextureIds.end()) {
+        throw std::runtime_error("No texture with id " + std::to_string(id) + " is loaded");
+    }
+
+    return it->second;
+}
+
+ModelHandle ResourceManager::LoadModel(const std::string& name, const Model::Builder& builder) {
+    ResourceId id = MakeResourceId(name);
+
     // check if a model with the given name has already been loaded
-    if (std::find(mModelNames.begin(), mModelNames.end(), name) != mModelNames.end()) {
-        throw std::runtime_error("Texture named " + name + " has already been loaded");
+    if (mModelIds.contains(id)) {
+        throw std::runtime_error("Model named " + name + " has already been loaded");
     }
 
-    mModelNames.push_back(name);
-    mModelMap[name] = std::make_unique<Model>(mDevice, builder);
+    ModelHandle handle = mModels.Reserve();
+    mModelIds[id] = handle;
+    Track(mModelUsage, handle.index, handle.generation, id, false);
+    auto model = std::make_unique<Model>(*mGeometryPool, builder, *mUploadManager);
+    mPendingModels.push_back({handle, std::move(model), mUploadManager->GetOpenBatch()});
+
+    return handle;
+}
+
+ModelHandle ResourceManager::LoadModel(const std::string& name, const std::string& filePath) {
+    MeshImporter::Stats stats;
+    Model::Builder builder = MeshImporter::Load(filePath, &stats);
+
+    // meshes are authored in unit space and scaled by their transform
+    builder.vertexFormat = Model::VertexFormat::COMPACT;
+
+    gCoordinator.LogInfo(filePath, ": ", stats.corners, " corners -> ", stats.vertices, " vertices, ",
+                         stats.triangles, " triangles, ACMR ", stats.acmrBefore, " -> ", stats.acmrAfter);
+
+    return LoadModel(name, builder);
 }
 
-Model *ResourceManager::GetModel(const std::string& name) {
-    if (std::find(mModelNames.begin(), mModelNames.end(), name) == mModelNames.end()) {
-        throw std::runtime_error("No texture named " + name + " is loaded");
+ModelHandle ResourceManager::FindModel(ResourceId id) const {
+    auto it = mModelIds.find(id);
+
+    if (it == mModelIds.end()) {
+        throw std::runtime_error("No model with id " + std::to_string(id) + " is loaded");
     }
 
-    return mModelMap[name].get();
+    return it->second;
 }
@@ -1,32 +1,377 @@
 #pragma once
 
+#include <asset_pack.hpp>
+#include <bindless_texture_table.hpp>
+#include <geometry_pool.hpp>
 #include <texture.hpp>
+#include <texture_atlas.hpp>
 #include <model.hpp>
 #include <unordered_map>
 #include <device.hpp>
+#include <resource_handle.hpp>
+#include <upload_manager.hpp>
+#include "core/thread_pool.hpp"
+#include "core/io/file_watcher.hpp"
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <optional>
+
+enum class AssetStatus {
+    PENDING,
+    READY,
+    FAILED
+};
+
+// Result of an asynchronous load. The handle is valid immediately, so it can
+// be stored in components right away, but it only resolves once IsReady().
+// A load whose source bytes turn out to match a loaded resource resolves to
+// that resource instead, GetHandle then returns its handle.
+template<typename Handle>
+class AssetFuture {
+public:
+    AssetFuture() = default;
+
+    AssetStatus GetStatus() const {
+        return mState ? mState->status.load(std::memory_order_acquire) : AssetStatus::FAILED;
+    }
+
+    bool IsReady() const { return GetStatus() == AssetStatus::READY; }
+    bool IsFailed() const { return GetStatus() == AssetStatus::FAILED; }
+
+    Handle GetHandle() const {
+        return IsReady() && mState->alias.IsValid() ? mState->alias : mHandle;
+    }
+
+    // Only meaningful once IsFailed()
+    const std::string& GetError() const { return mState->error; }
+
+private:
+    friend class ResourceManager;
+
+    struct State {
+        std::atomic<AssetStatus> status{AssetStatus::PENDING};
+        std::string error;
+        // resource shared by content, written before status turns READY
+        Handle alias;
+    };
+
+    Handle mHandle;
+    std::shared_ptr<State> mState;
+};
+
+using TextureFuture = AssetFuture<TextureHandle>;
 
 class ResourceManager {
 
 public:
+    // Bytes held by resources, device memory and host memory
+    struct MemoryUsage {
+        VkDeviceSize gpuBytes = 0;
+        size_t cpuBytes = 0;
+    };
+
+    // Loads that found their source bytes already loaded under another name
+    // and share that resource instead
+    struct DedupStats {
+        uint32_t aliases = 0;
+        // source bytes that were neither decoded nor uploaded again
+        uint64_t bytesSaved = 0;
+    };
+
+    ~ResourceManager();
+
     void Init(std::shared_ptr<Device> device) {
+        sInstance = this;
         mDevice = device;
+        mUploadManager = std::make_unique<UploadManager>(device);
+        mGeometryPool = std::make_unique<GeometryPool>(device);
+        mLoaderPool = std::make_unique<ThreadPool>();
+
+        // without linear blits mip chains are built on the loader threads
+        mCpuMips = !device->SupportsLinearBlit(VK_FORMAT_R8G8B8A8_SRGB);
+
+        if (device->SupportsBindlessTextures()) {
+            mTextureTable = std::make_unique<BindlessTextureTable>(device);
+        }
     }
 
     void LoadResources();
 
+    // Finishes loads: records everything decoded since the last call,
+    // flushes all pending uploads in one submission and publishes resources
+    // the GPU has finished uploading. Must be called from the thread that
+    // submits rendering work, before it submits the frame.
+    void Update();
+
+    UploadManager& GetUploadManager() {
+        return *mUploadManager;
+    }
+
+    GeometryPool& GetGeometryPool() {
+        return *mGeometryPool;
+    }
+
+    // Once either budget is exceeded, Update evicts textures and models no
+    // ResourceRef points to, least recently used first. Evicted resources
+    // are forgotten by name and have to be loaded again. Unlimited by default
+    void SetMemoryBudget(const MemoryUsage& budget) {
+        mBudget = budget;
+    }
+
+    MemoryUsage GetMemoryUsage() const {
+        return mUsage;
+    }
+
+    DedupStats GetDedupStats() const {
+        return mDedupStats;
+    }
+
+    // Reference counting behind ResourceRef
+    void Retain(TextureHandle handle);
+    void Release(TextureHandle handle);
+    void Retain(ModelHandle handle);
+    void Release(ModelHandle handle);
+
+    // nullptr outside of Init and destruction, references held by
+    // components that outlive the manager are dropped silently
+    static ResourceManager *GetInstance() {
+        return sInstance;
+    }
+
+    // Every loaded texture at the index of its handle, nullptr when the
+    // device has no descriptor indexing
+    BindlessTextureTable *GetTextureTable() const {
+        return mTextureTable.get();
+    }
+
+    // Slot of the texture in the texture table, differs from the handle
+    // index once the texture has been hot reloaded
+    uint32_t GetTextureSlot(TextureHandle handle) const {
+        const std::optional<uint32_t>& spareSlot = mTextureUsage[handle.index].spareSlot;
+        return spareSlot ? *spareSlot : handle.index;
+    }
+
+    // Watches the texture directories and reloads textures whose files
+    // change. Reloads decode on the loader threads and are swapped in by
+    // Update once uploaded, handles stay the same. A texture follows every
+    // file with the stem of the file it was loaded from, so rewriting the
+    // source image or recooking the .vkft both reload it. Packed textures
+    // and sprites are not watched. Names sharing a texture through content
+    // dedup follow the file of the first name
+    void EnableHotReload();
+
+    // Load* hand out handles right away, they resolve once the upload has
+    // completed, see IsLoaded. Source bytes are hashed first, a name whose
+    // bytes match a loaded resource becomes another name for that resource
+
     // Uses default image view and samplers
-    void LoadTexture(const std::string& name, const std::string& filePath);
-    Texture *GetTexture(const std::string& name);
+    TextureHandle LoadTexture(const std::string& name, const std::string& filePath);
+    // Reads, hashes and decodes on a worker thread, see Update. Duplicates
+    // are only found then, their reserved handle is released and the
+    // future resolves to the texture they duplicate
+    TextureFuture LoadTextureAsync(const std::string& name, const std::string& filePath);
+    TextureHandle FindTexture(ResourceId id) const;
+
+    // Switches texture loading to a pack archive built by AssetPacker. The
+    // pack stays mapped and packed textures are copied or decompressed
+    // from it straight into staging memory
+    void OpenPack(const std::string& filePath);
+    bool HasPack() const {
+        return mPack != nullptr;
+    }
+
+    TextureHandle LoadPackedTexture(const std::string& name);
+
+    // Packs the image into the sprite atlas. Sprites share a few large page
+    // textures, see GetSpriteRegion
+    SpriteHandle LoadSprite(const std::string& name, const std::string& filePath);
+    SpriteHandle FindSprite(ResourceId id) const;
+
+    ModelHandle LoadModel(const std::string& name, const Model::Builder& builder);
+    // Imports a mesh file, see MeshImporter
+    ModelHandle LoadModel(const std::string& name, const std::string& filePath);
+    ModelHandle FindModel(ResourceId id) const;
+
+    // False while the upload is still in flight
+    bool IsLoaded(TextureHandle handle) const {
+        return mTextures.Contains(handle);
+    }
+
+    bool IsLoaded(ModelHandle handle) const {
+        return mModels.Contains(handle);
+    }
+
+    // False until a page upload containing the sprite has completed
+    bool IsLoaded(SpriteHandle handle) const {
+        return mAtlas.IsPublished(handle);
+    }
+
+    // Render time resolution, handles must come from Load* or Find*
+    Texture *GetTexture(TextureHandle handle) const {
+        return mTextures.Get(handle);
+    }
 
-    void LoadModel(const std::string& name, const Model::Builder& builder);
-    Model *GetModel(const std::string& name);
+    Model *GetModel(ModelHandle handle) const {
+        return mModels.Get(handle);
+    }
+
+    AtlasRegion GetSpriteRegion(SpriteHandle handle) const {
+        return mAtlas.GetRegion(handle);
+    }
 
 private:
-    std::unordered_map<std::string, std::unique_ptr<Texture>> mTextureMap;
-    std::vector<std::string> mTextureNames;
+    struct DecodedTexture {
+        ResourceId id;
+        TextureFuture future;
+        std::optional<Texture::ImageData> image;
+        std::string error;
+        // XXH64 and size of the source bytes, 0 for reloads
+        uint64_t contentHash = 0;
+        size_t size = 0;
+        // replaces the texture of future.mHandle instead of publishing it
+        bool reload = false;
+    };
+
+    // async load found to duplicate another texture, resolves along with it
+    struct AliasedTexture {
+        TextureFuture future;
+        TextureFuture target;
+    };
+
+    struct PendingTexture {
+        TextureFuture future;
+        std::unique_ptr<Texture> texture;
+        // open batch when the upload was recorded, see UploadManager::GetOpenBatch
+        UploadManager::BatchId batchId;
+        bool reload = false;
+    };
 
-    std::unordered_map<std::string, std::unique_ptr<Model>> mModelMap;
-    std::vector<std::string> mModelNames;
+    struct PendingModel {
+        ModelHandle handle;
+        std::unique_ptr<Model> model;
+        UploadManager::BatchId batchId;
+    };
+
+    struct PendingAtlasPage {
+        TextureAtlas::PageSnapshot snapshot;
+        TextureHandle handle;
+        std::unique_ptr<Texture> texture;
+        UploadManager::BatchId batchId;
+    };
+
+    // Bookkeeping for the resource in the pool slot of the same index
+    struct ResourceUsage {
+        // of the handle the entry belongs to, 0 for unused slots
+        uint32_t generation = 0;
+        uint32_t refCount = 0;
+        uint64_t lastUsedFrame = 0;
+        MemoryUsage memory;
+        ResourceId id = 0;
+        // XXH64 of the source bytes, 0 when not deduplicated
+        uint64_t contentHash = 0;
+        // owned by the atlas, never evicted
+        bool pinned = false;
+        bool retiring = false;
+        // texture table slot of a hot reloaded texture, see GetTextureSlot
+        std::optional<uint32_t> spareSlot;
+    };
+
+    // released resources may still be used by frames in flight
+    template<typename Handle>
+    struct Retired {
+        Handle handle;
+        uint64_t releaseFrame;
+    };
+
+    // previous version of a hot reloaded texture
+    struct ReplacedTexture {
+        std::unique_ptr<Texture> texture;
+        std::optional<uint32_t> spareSlot;
+        uint64_t releaseFrame;
+    };
+
+    void UploadDecodedTextures();
+    void UploadAtlasPages();
+    void PublishUploadedResources();
+    // False if the texture table has no slot for handle, the texture is
+    // dropped then
+    bool PublishTexture(TextureHandle handle, std::unique_ptr<Texture> texture);
+    void PublishModel(ModelHandle handle, std::unique_ptr<Model> model);
+    void ReplaceTexture(TextureHandle handle, std::unique_ptr<Texture> texture);
+
+    void WatchTextureSource(ResourceId id, const std::string& filePath);
+    void ReloadChangedTextures();
+    void DecodeTextureAsync(ResourceId id, TextureFuture future, const std::string& filePath, bool reload);
+    // Points the name of decoded at the texture with the same source bytes
+    // and releases its reserved handle. False if there is none
+    bool AliasDecodedTexture(DecodedTexture& decoded);
+    void ResolveAliasedTextures();
+
+    // The loaded texture with these source bytes, registered under id as
+    // well. Invalid future if there is none
+    TextureFuture FindTextureContent(ResourceId id, uint64_t contentHash, size_t size);
+    void TrackTextureContent(TextureFuture future, uint64_t contentHash);
+    void ForgetTexture(TextureHandle handle);
+    // Releases the reserved handle of a load that did not make it
+    void FailTexture(const TextureFuture& future, std::string error);
+
+    static ResourceUsage *FindUsage(std::vector<ResourceUsage>& usages, uint32_t index, uint32_t generation);
+    static void Track(std::vector<ResourceUsage>& usages, uint32_t index, uint32_t generation, ResourceId id, bool pinned);
+
+    void RetireTexture(TextureHandle handle);
+    void RetireModel(ModelHandle handle);
+    void ReleaseRetiredResources();
+    void EvictToBudget();
+
+    // models free their ranges on destruction, so it outlives them
+    std::unique_ptr<GeometryPool> mGeometryPool;
+
+    ResourcePool<Texture> mTextures;
+    std::unordered_map<ResourceId, TextureHandle> mTextureIds;
+    // by source bytes, futures of textures still loading resolve with them
+    std::unordered_map<uint64_t, TextureFuture> mTextureContents;
+
+    TextureAtlas mAtlas;
+    std::unordered_map<ResourceId, SpriteHandle> mSpriteIds;
+    std::unordered_map<uint64_t, SpriteHandle> mSpriteContents;
+
+    ResourcePool<Model> mModels;
+    std::unordered_map<ResourceId, ModelHandle> mModelIds;
+
+    std::mutex mDecodedMutex;
+    std::vector<DecodedTexture> mDecodedTextures;
+    std::vector<PendingTexture> mPendingTextures;
+    std::vector<AliasedTexture> mAliasedTextures;
+    std::vector<PendingModel> mPendingModels;
+    std::vector<PendingAtlasPage> mPendingAtlasPages;
+
+    std::vector<ResourceUsage> mTextureUsage;
+    std::vector<ResourceUsage> mModelUsage;
+
+    std::vector<Retired<TextureHandle>> mRetiredTextures;
+    std::vector<Retired<ModelHandle>> mRetiredModels;
+    std::vector<ReplacedTexture> mReplacedTextures;
+    uint64_t mFrame = 0;
+
+    MemoryUsage mUsage;
+    DedupStats mDedupStats;
+    MemoryUsage mBudget{std::numeric_limits<VkDeviceSize>::max(), std::numeric_limits<size_t>::max()};
+
+    static inline ResourceManager *sInstance = nullptr;
 
     std::shared_ptr<Device> mDevice;
+    std::unique_ptr<AssetPack> mPack;
+
+    // file stem to the texture loaded from it
+    std::unordered_map<std::string, ResourceId> mTextureSources;
+    std::unique_ptr<FileWatcher> mWatcher;
+    std::unique_ptr<BindlessTextureTable> mTextureTable;
+    // waits for in-flight uploads before pending resources are destroyed
+    std::unique_ptr<UploadManager> mUploadManager;
+
+    // destroyed first, so no worker outlives the queues it reports to
+    std::unique_ptr<ThreadPool> mLoaderPool;
+    bool mCpuMips = false;
 };
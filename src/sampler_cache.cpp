@@ -0,0 +1,107 @@
+#include <sampler_cache.hpp>
+
+#include "core/coordinator.hpp"
+
+// std
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+
+extern Coordinator gCoordinator;
+
+SamplerCache::SamplerCache(VkDevice device, const VkPhysicalDeviceProperties& properties) :
+    mDevice(device),
+    mMaxAnisotropy(properties.limits.maxSamplerAnisotropy) {
+}
+
+SamplerCache::~SamplerCache() {
+    assert(mSamplers.empty() && "Destroying sampler cache while samplers are still referenced.");
+
+    for (const auto& [key, entry] : mSamplers) {
+        vkDestroySampler(mDevice, entry.sampler, nullptr);
+    }
+}
+
+SamplerCache::SamplerRef SamplerCache::Acquire(const VkSamplerCreateInfo& createInfo) {
+    assert(createInfo.pNext == nullptr && "Sampler create info chains are not cached.");
+
+    Key key{createInfo.flags,
+            createInfo.magFilter,
+            createInfo.minFilter,
+            createInfo.mipmapMode,
+            createInfo.addressModeU,
+            createInfo.addressModeV,
+            createInfo.addressModeW,
+            createInfo.mipLodBias,
+            createInfo.anisotropyEnable,
+            createInfo.maxAnisotropy,
+            createInfo.compareEnable,
+            createInfo.compareOp,
+            createInfo.minLod,
+            createInfo.maxLod,
+            createInfo.borderColor,
+            createInfo.unnormalizedCoordinates};
+
+    auto it = mSamplers.find(key);
+
+    if (it != mSamplers.end()) {
+        return it->second.ref.lock();
+    }
+
+    VkSampler sampler;
+    if (vkCreateSampler(mDevice, &createInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler");
+    }
+
+    // map nodes do not move, the reference points into the entry
+    Entry& entry = mSamplers.emplace(key, Entry{sampler, {}}).first->second;
+    SamplerRef ref(&entry.sampler, [this, key](const VkSampler *) {
+        Release(key);
+    });
+
+    entry.ref = ref;
+
+    gCoordinator.LogDebug("sampler cache: ", mSamplers.size(), " unique samplers");
+    return ref;
+}
+
+SamplerCache::SamplerRef SamplerCache::Acquire(const SamplerSettings& settings) {
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = settings.filter;
+    samplerInfo.minFilter = settings.filter;
+    samplerInfo.addressModeU = settings.addressMode;
+    samplerInfo.addressModeV = settings.addressMode;
+    samplerInfo.addressModeW = settings.addressMode;
+    samplerInfo.anisotropyEnable = settings.anisotropy ? VK_TRUE : VK_FALSE;
+    samplerInfo.maxAnisotropy = settings.anisotropy ? mMaxAnisotropy : 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = settings.mipmapMode;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = settings.minLod;
+    samplerInfo.maxLod = settings.maxLod;
+
+    return Acquire(samplerInfo);
+}
+
+void SamplerCache::Release(const Key& key) {
+    auto it = mSamplers.find(key);
+
+    vkDestroySampler(mDevice, it->second.sampler, nullptr);
+    mSamplers.erase(it);
+}
+
+size_t SamplerCache::KeyHash::operator()(const Key& key) const {
+    // FNV-1a over the raw fields
+    const auto *bytes = reinterpret_cast<const unsigned char *>(&key);
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < sizeof(Key); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+
+    return static_cast<size_t>(hash);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+
+// Sampler parameters a texture can choose, everything else is fixed
+struct SamplerSettings {
+    VkFilter filter = VK_FILTER_LINEAR;
+    VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    bool anisotropy = true;
+    float minLod = 0.0f;
+    // the image view already limits sampling to the existing levels, so
+    // textures with different mip counts can share a sampler
+    float maxLod = VK_LOD_CLAMP_NONE;
+};
+
+// Deduplicates samplers. Identical create infos share one VkSampler, which
+// is destroyed when its last reference goes away. Drivers cap the number of
+// samplers and every texture used to create its own. Not thread safe,
+// textures are created on the main thread.
+class SamplerCache {
+public:
+    // Keeps the sampler alive, dereference for the handle
+    using SamplerRef = std::shared_ptr<const VkSampler>;
+
+    SamplerCache(VkDevice device, const VkPhysicalDeviceProperties& properties);
+    ~SamplerCache();
+
+    SamplerCache(const SamplerCache &) = delete;
+    SamplerCache &operator=(const SamplerCache &) = delete;
+
+    // createInfo must not have a pNext chain
+    SamplerRef Acquire(const VkSamplerCreateInfo& createInfo);
+    SamplerRef Acquire(const SamplerSettings& settings);
+
+    // Unique samplers alive right now
+    size_t GetSamplerCount() const {
+        return mSamplers.size();
+    }
+
+private:
+    // the hashed fields of VkSamplerCreateInfo, all 4 bytes wide so the
+    // struct has no padding
+    struct Key {
+        VkSamplerCreateFlags flags;
+        VkFilter magFilter;
+        VkFilter minFilter;
+        VkSamplerMipmapMode mipmapMode;
+        VkSamplerAddressMode addressModeU;
+        VkSamplerAddressMode addressModeV;
+        VkSamplerAddressMode addressModeW;
+        float mipLodBias;
+        VkBool32 anisotropyEnable;
+        float maxAnisotropy;
+        VkBool32 compareEnable;
+        VkCompareOp compareOp;
+        float minLod;
+        float maxLod;
+        VkBorderColor borderColor;
+        VkBool32 unnormalizedCoordinates;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        VkSampler sampler;
+        std::weak_ptr<const VkSampler> ref;
+    };
+
+    void Release(const Key& key);
+
+    VkDevice mDevice;
+    float mMaxAnisotropy;
+
+    std::unordered_map<Key, Entry, KeyHash> mSamplers;
+};
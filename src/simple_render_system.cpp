@@ -3,15 +3,111 @@
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include "core/coordinator.hpp"
 #include <swap_chain.hpp>
 
 #include <components/transform.hpp>
 #include <components/renderable.hpp>
+#include <resource_manager.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <optional>
 
 
 extern Coordinator gCoordinator;
+extern ResourceManager gResourceManager;
+
+namespace {
+
+const std::string SHADER_DIRECTORY = "../shaders";
+const std::string VERT_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader.vert.spv";
+const std::string FRAG_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader.frag.spv";
+const std::string BINDLESS_FRAG_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader_bindless.frag.spv";
+const std::string INSTANCED_VERT_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader_instanced.vert.spv";
+const std::string INSTANCED_FRAG_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader_instanced.frag.spv";
+const std::string INSTANCED_BINDLESS_FRAG_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader_instanced_bindless.frag.spv";
+// sprite batch vertices carry the same varyings as instances
+const std::string BATCHED_VERT_SHADER_PATH = SHADER_DIRECTORY + "/simple_shader_batched.vert.spv";
+
+const char *RenderPathName(SimpleRenderSystem::RenderPath renderPath) {
+    switch (renderPath) {
+        case SimpleRenderSystem::RenderPath::PER_DRAW:
+            return "per draw";
+        case SimpleRenderSystem::RenderPath::INSTANCED:
+            return "instanced";
+        default:
+            return "batched";
+    }
+}
+
+// Compiles source into source.spv next to it, returns the compiler output
+// when it fails
+std::string CompileShader(const std::string& source) {
+    std::string command = "glslc \"" + source + "\" -o \"" + source + ".spv\" 2>&1";
+
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        return "cannot run glslc for " + source;
+    }
+
+    std::string output;
+    std::array<char, 256> buffer;
+
+    while (fgets(buffer.data(), static_cast<int>(buffer.size()), pipe)) {
+        output += buffer.data();
+    }
+
+    if (pclose(pipe) != 0) {
+        return output.empty() ? "glslc failed for " + source : output;
+    }
+
+    return {};
+}
+
+}
+
+VkVertexInputBindingDescription SimpleRenderSystem::Instance::GetBindingDescription() {
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 1;
+    bindingDescription.stride = sizeof(Instance);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    return bindingDescription;
+}
+
+std::vector<VkVertexInputAttributeDescription> SimpleRenderSystem::Instance::GetAttributeDescriptions() {
+    // locations 0 to 2 are the model's vertex attributes
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
+    attributeDescriptions[0].binding = 1;
+    attributeDescriptions[0].location = 3;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributeDescriptions[0].offset = offsetof(Instance, basis);
+
+    attributeDescriptions[1].binding = 1;
+    attributeDescriptions[1].location = 4;
+    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attributeDescriptions[1].offset = offsetof(Instance, position);
+
+    attributeDescriptions[2].binding = 1;
+    attributeDescriptions[2].location = 5;
+    attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[2].offset = offsetof(Instance, color);
+
+    attributeDescriptions[3].binding = 1;
+    attributeDescriptions[3].location = 6;
+    attributeDescriptions[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributeDescriptions[3].offset = offsetof(Instance, uvRect);
+
+    return attributeDescriptions;
+}
 
 SimpleRenderSystem::SimpleRenderSystem() {
 
@@ -23,36 +119,31 @@ SimpleRenderSystem::~SimpleRenderSystem() {
 
 void SimpleRenderSystem::Init(std::shared_ptr<Device> device, VkRenderPass renderPass) {
     mDevice = device;
+    mTextureTable = gResourceManager.GetTextureTable();
 
     CreateDescriptorSetLayouts();
     CreatePipelineLayout();
     CreatePipeline(renderPass);
 
-    CreateUniformBuffers();
+    mSpriteBatch = std::make_unique<SpriteBatch>(gResourceManager.GetGeometryPool(),
+                                                 gResourceManager.GetUploadManager());
 }
 
 void SimpleRenderSystem::CreateDescriptorSetLayouts() {
+    // the texture table is its own set, only the ubo is pushed
+    if (mTextureTable) {
+        mDescriptorSetLayout = DescriptorSetLayout::Builder(mDevice)
+            .AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+            .Build();
+        return;
+    }
+
     mDescriptorSetLayout = DescriptorSetLayout::Builder(mDevice)
         .AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
         .AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
         .Build();
 }
 
-void SimpleRenderSystem::CreateUniformBuffers() {
-    for (int i = 0; i < SwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-        auto buffer = std::make_unique<Buffer>(
-            mDevice,
-            sizeof(SimpleRenderSystem::Ubo),
-            1,
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
-        );
-
-        mUboBuffers.push_back(std::move(buffer));
-        mUboBuffers[i]->Map();
-    }
-} 
-
 void SimpleRenderSystem::CreatePipelineLayout() {
     VkPushConstantRange vertexPushConstantRange{};
     vertexPushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
@@ -68,6 +159,10 @@ void SimpleRenderSystem::CreatePipelineLayout() {
 
     std::vector<VkDescriptorSetLayout> descriptorSetLayouts{mDescriptorSetLayout->GetDescriptorSetLayout()};
 
+    if (mTextureTable) {
+        descriptorSetLayouts.push_back(mTextureTable->GetDescriptorSetLayout());
+    }
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
@@ -86,37 +181,196 @@ void SimpleRenderSystem::CreatePipeline(VkRenderPass renderPass) {
     Pipeline::ConfigInfo pipelineConfig{};
     Pipeline::DefaultConfigInfo(pipelineConfig);
 
+    mRenderPass = renderPass;
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = mPipelineLayout;
 
-    mPipeline = std::make_unique<Pipeline>(mDevice,
-                                           "../shaders/simple_shader.vert.spv",
-                                           "../shaders/simple_shader.frag.spv",
-                                           pipelineConfig);
+    // the shaders take every vertex format, normalized and half attributes
+    // are converted to float by the input assembler
+    Pipelines pipelines;
+    Pipelines instancedPipelines;
+
+    for (size_t i = 0; i < Model::VERTEX_FORMAT_COUNT; i++) {
+        auto format = static_cast<Model::VertexFormat>(i);
+        pipelineConfig.bindingDescriptions = Model::GetBindingDescriptions(format);
+        pipelineConfig.attributeDescriptions = Model::GetAttributeDescriptions(format);
+
+        pipelines[i] = std::make_unique<Pipeline>(mDevice,
+                                                  VERT_SHADER_PATH,
+                                                  mTextureTable ? BINDLESS_FRAG_SHADER_PATH : FRAG_SHADER_PATH,
+                                                  pipelineConfig);
+
+        auto instanceAttributes = Instance::GetAttributeDescriptions();
+        pipelineConfig.bindingDescriptions.push_back(Instance::GetBindingDescription());
+        pipelineConfig.attributeDescriptions.insert(pipelineConfig.attributeDescriptions.end(),
+                                                    instanceAttributes.begin(),
+                                                    instanceAttributes.end());
+
+        instancedPipelines[i] = std::make_unique<Pipeline>(
+            mDevice,
+            INSTANCED_VERT_SHADER_PATH,
+            mTextureTable ? INSTANCED_BINDLESS_FRAG_SHADER_PATH : INSTANCED_FRAG_SHADER_PATH,
+            pipelineConfig);
+    }
+
+    pipelineConfig.bindingDescriptions = SpriteBatch::Vertex::GetBindingDescriptions();
+    pipelineConfig.attributeDescriptions = SpriteBatch::Vertex::GetAttributeDescriptions();
+
+    auto batchPipeline = std::make_unique<Pipeline>(
+        mDevice,
+        BATCHED_VERT_SHADER_PATH,
+        mTextureTable ? INSTANCED_BINDLESS_FRAG_SHADER_PATH : INSTANCED_FRAG_SHADER_PATH,
+        pipelineConfig);
+
+    mPipelines = std::move(pipelines);
+    mInstancedPipelines = std::move(instancedPipelines);
+    mBatchPipeline = std::move(batchPipeline);
 }
 
-void SimpleRenderSystem::Render(VkCommandBuffer commandBuffer, int frameIndex) {
-    mPipeline->Bind(commandBuffer);
+void SimpleRenderSystem::EnableHotReload() {
+    mShaderWatcher = std::make_unique<FileWatcher>();
+    mShaderCompiler = std::make_unique<ThreadPool>(1);
 
-    for (auto& entity : mEntities) {
-        auto& transform = gCoordinator.GetComponent<Transform>(entity);
-        auto& renderable = gCoordinator.GetComponent<Renderable>(entity);
+    if (!mShaderWatcher->Watch(SHADER_DIRECTORY)) {
+        gCoordinator.LogInfo("hot reload: cannot watch ", SHADER_DIRECTORY);
+    }
+}
+
+void SimpleRenderSystem::ReloadChangedShaders() {
+    mFrame++;
 
-        auto bufferInfo = mUboBuffers[frameIndex]->DescriptorInfo();
-        auto imageInfo = renderable.texture->DescriptorInfo();
+    std::erase_if(mRetiredPipelines, [this](const RetiredPipelines& retired) {
+        return retired.releaseFrame <= mFrame;
+    });
 
-        Ubo ubo{};
-        ubo.projection = glm::ortho(0.0f, 1280.f, 720.0f, 0.0f, 0.0f, 1.0f);
-        ubo.view = glm::mat4(1.f);
+    if (!mShaderWatcher) {
+        return;
+    }
+
+    std::erase_if(mShaderBuilds, [](std::future<std::string>& build) {
+        if (build.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        std::string output = build.get();
+        if (!output.empty()) {
+            gCoordinator.LogError(output);
+        }
+        return true;
+    });
+
+    bool rebuild = false;
+
+    // new SPIR-V triggers another change, the pipeline is rebuilt from that
+    for (const std::string& filePath : mShaderWatcher->TakeChanges()) {
+        std::string extension = std::filesystem::path(filePath).extension().string();
+
+        if (extension == ".vert" || extension == ".frag") {
+            mShaderBuilds.push_back(mShaderCompiler->Submit([filePath]() {
+                return CompileShader(filePath);
+            }));
+        } else if (filePath == VERT_SHADER_PATH ||
+                   filePath == INSTANCED_VERT_SHADER_PATH ||
+                   filePath == BATCHED_VERT_SHADER_PATH ||
+                   filePath == (mTextureTable ? BINDLESS_FRAG_SHADER_PATH : FRAG_SHADER_PATH) ||
+                   filePath == (mTextureTable ? INSTANCED_BINDLESS_FRAG_SHADER_PATH : INSTANCED_FRAG_SHADER_PATH)) {
+            rebuild = true;
+        }
+    }
 
-        mUboBuffers[frameIndex]->WriteToBuffer(&ubo);
+    if (!rebuild) {
+        return;
+    }
+
+    Pipelines previous = std::move(mPipelines);
+    Pipelines previousInstanced = std::move(mInstancedPipelines);
+    std::unique_ptr<Pipeline> previousBatch = std::move(mBatchPipeline);
+
+    try {
+        CreatePipeline(mRenderPass);
+    } catch (const std::runtime_error& e) {
+        gCoordinator.LogError("hot reload: ", e.what());
+        mPipelines = std::move(previous);
+        mInstancedPipelines = std::move(previousInstanced);
+        mBatchPipeline = std::move(previousBatch);
+        return;
+    }
+
+    gCoordinator.LogInfo("hot reload: rebuilt pipelines");
+
+    // Render runs once per frame after the frame waited for its slot
+    mRetiredPipelines.push_back({std::move(previous),
+                                 std::move(previousInstanced),
+                                 std::move(previousBatch),
+                                 mFrame + SwapChain::MAX_FRAMES_IN_FLIGHT});
+}
+
+void SimpleRenderSystem::EnableBenchmark() {
+    mBenchmark = {};
+    mBenchmark.enabled = true;
+    mRenderPath = RenderPath::PER_DRAW;
+}
+
+void SimpleRenderSystem::Render(VkCommandBuffer commandBuffer, FrameRingBuffer& frameRing) {
+    ReloadChangedShaders();
+
+    auto recordStart = std::chrono::steady_clock::now();
+
+    mDraws.clear();
+
+    for (auto& entity : mEntities) {
+        auto& renderable = gCoordinator.GetComponent<Renderable>(entity);
+
+        // still streaming in
+        if (!gResourceManager.IsLoaded(renderable.model)) {
+            continue;
+        }
+
+        Model *model = gResourceManager.GetModel(renderable.model);
+
+        if (renderable.sprite.IsValid()) {
+            if (!gResourceManager.IsLoaded(renderable.sprite)) {
+                continue;
+            }
+
+            AtlasRegion region = gResourceManager.GetSpriteRegion(renderable.sprite);
+            mDraws.push_back({entity, region.page, region.uvRect, model->GetVertexFormat(), model});
+        } else if (gResourceManager.IsLoaded(renderable.texture)) {
+            mDraws.push_back({entity,
+                              renderable.texture,
+                              glm::vec4(0.0f, 0.0f, 1.0f, 1.0f),
+                              model->GetVertexFormat(),
+                              model});
+        }
+    }
 
+    // sprites sharing an atlas page end up next to each other and only
+    // need their descriptors pushed once, pipelines switch once per format.
+    // Ordering by model last makes the instanced path's groups contiguous
+    std::sort(mDraws.begin(), mDraws.end(), [](const Draw& a, const Draw& b) {
+        if (a.vertexFormat != b.vertexFormat) {
+            return a.vertexFormat < b.vertexFormat;
+        }
+        if (a.texture.index != b.texture.index) {
+            return a.texture.index < b.texture.index;
+        }
+        return std::less<Model *>()(a.model, b.model);
+    });
+
+    Ubo ubo{};
+    ubo.projection = glm::ortho(0.0f, 1280.f, 720.0f, 0.0f, 0.0f, 1.0f);
+    ubo.view = glm::mat4(1.f);
+
+    // push descriptors carry the offset, no dynamic offsets needed
+    FrameRingBuffer::Allocation uboAllocation = frameRing.Push(ubo);
+    VkDescriptorBufferInfo bufferInfo{uboAllocation.buffer, uboAllocation.offset, sizeof(Ubo)};
+
+    // descriptor work is the same every frame no matter how much is drawn
+    if (mTextureTable) {
         auto descriptorWrites = DescriptorWriter(*mDescriptorSetLayout)
             .WriteBuffer(0, &bufferInfo)
-            .WriteImage(1, &imageInfo)
             .GetWrites();
 
-        // attach ubo descriptor writes to command buffer
         mDevice->vkCmdPushDescriptorSetKHR(
             commandBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -126,12 +380,67 @@ void SimpleRenderSystem::Render(VkCommandBuffer commandBuffer, int frameIndex) {
             descriptorWrites.data()
         );
 
+        VkDescriptorSet textureSet = mTextureTable->GetDescriptorSet();
+        vkCmdBindDescriptorSets(
+            commandBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            mPipelineLayout,
+            1,
+            1,
+            &textureSet,
+            0,
+            nullptr
+        );
+    }
+
+    uint32_t drawCount;
+
+    switch (mRenderPath) {
+        case RenderPath::INSTANCED:
+            drawCount = RenderInstanced(commandBuffer, frameRing, bufferInfo);
+            break;
+        case RenderPath::BATCHED:
+            drawCount = RenderBatched(commandBuffer, frameRing, bufferInfo);
+            break;
+        default:
+            drawCount = RenderPerDraw(commandBuffer, bufferInfo);
+            break;
+    }
+
+    if (mBenchmark.enabled) {
+        UpdateBenchmark(std::chrono::steady_clock::now() - recordStart, drawCount);
+    }
+}
+
+uint32_t SimpleRenderSystem::RenderPerDraw(VkCommandBuffer commandBuffer, const VkDescriptorBufferInfo& bufferInfo) {
+    TextureHandle boundTexture{};
+    Pipeline *boundPipeline = nullptr;
+    // every model lives in the same geometry pool buffers
+    std::optional<VkIndexType> boundIndexType;
+
+    for (const auto& draw : mDraws) {
+        auto& transform = gCoordinator.GetComponent<Transform>(draw.entity);
+        auto& renderable = gCoordinator.GetComponent<Renderable>(draw.entity);
+
+        Pipeline *pipeline = mPipelines[static_cast<size_t>(draw.vertexFormat)].get();
+        if (pipeline != boundPipeline) {
+            pipeline->Bind(commandBuffer);
+            boundPipeline = pipeline;
+        }
+
+        if (!mTextureTable && !(draw.texture == boundTexture)) {
+            PushDescriptors(commandBuffer, draw.texture, bufferInfo);
+            boundTexture = draw.texture;
+        }
+
         VertexPushData vertexPush{};
         vertexPush.model = transform.GetModelMatrix();
+        vertexPush.uvRect = draw.uvRect;
 
         FragmentPushData fragmentPush{};
         fragmentPush.color = renderable.color;
         fragmentPush.opacity = renderable.opacity;
+        fragmentPush.textureIndex = gResourceManager.GetTextureSlot(draw.texture);
 
         vkCmdPushConstants(
             commandBuffer,
@@ -149,7 +458,187 @@ void SimpleRenderSystem::Render(VkCommandBuffer commandBuffer, int frameIndex) {
             sizeof(FragmentPushData),
             &fragmentPush);
 
-        renderable.model->Bind(commandBuffer);
-        renderable.model->Draw(commandBuffer);
+        if (draw.model->GetIndexType() != boundIndexType) {
+            draw.model->Bind(commandBuffer);
+            boundIndexType = draw.model->GetIndexType();
+        }
+
+        draw.model->Draw(commandBuffer);
+    }
+
+    return static_cast<uint32_t>(mDraws.size());
+}
+
+uint32_t SimpleRenderSystem::RenderInstanced(VkCommandBuffer commandBuffer,
+                                             FrameRingBuffer& frameRing,
+                                             const VkDescriptorBufferInfo& bufferInfo) {
+    constexpr VkDeviceSize INSTANCE_ALIGNMENT = 16;
+
+    VkDeviceSize available = frameRing.GetFrameSize() - frameRing.GetUsedBytes();
+    size_t capacity = available > INSTANCE_ALIGNMENT ? (available - INSTANCE_ALIGNMENT) / sizeof(Instance) : 0;
+    size_t count = std::min(mDraws.size(), capacity);
+
+    if (count < mDraws.size() && !mOverflowLogged) {
+        gCoordinator.LogError("instanced rendering: frame ring holds ", capacity, " of ", mDraws.size(),
+                              " instances, the rest is not drawn");
+        mOverflowLogged = true;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    FrameRingBuffer::Allocation allocation = frameRing.Allocate(count * sizeof(Instance), INSTANCE_ALIGNMENT);
+    auto *instances = static_cast<Instance *>(allocation.data);
+
+    // written in draw order, so each group is a contiguous instance range
+    for (size_t i = 0; i < count; i++) {
+        auto& transform = gCoordinator.GetComponent<Transform>(mDraws[i].entity);
+        auto& renderable = gCoordinator.GetComponent<Renderable>(mDraws[i].entity);
+        glm::mat4 model = transform.GetModelMatrix();
+
+        Instance instance;
+        instance.basis = glm::vec4(model[0].x, model[0].y, model[1].x, model[1].y);
+        instance.position = glm::vec3(model[3]);
+        instance.color = glm::packUnorm4x8(glm::vec4(renderable.color, renderable.opacity));
+        instance.uvRect = mDraws[i].uvRect;
+
+        instances[i] = instance;
+    }
+
+    vkCmdBindVertexBuffers(commandBuffer, 1, 1, &allocation.buffer, &allocation.offset);
+
+    TextureHandle boundTexture{};
+    Pipeline *boundPipeline = nullptr;
+    std::optional<VkIndexType> boundIndexType;
+    uint32_t drawCount = 0;
+
+    for (size_t first = 0; first < count;) {
+        const Draw& draw = mDraws[first];
+        size_t end = first + 1;
+
+        while (end < count && mDraws[end].model == draw.model && mDraws[end].texture == draw.texture) {
+            end++;
+        }
+
+        Pipeline *pipeline = mInstancedPipelines[static_cast<size_t>(draw.vertexFormat)].get();
+        if (pipeline != boundPipeline) {
+            pipeline->Bind(commandBuffer);
+            boundPipeline = pipeline;
+        }
+
+        if (!(draw.texture == boundTexture)) {
+            BindTexture(commandBuffer, draw.texture, bufferInfo);
+            boundTexture = draw.texture;
+        }
+
+        if (draw.model->GetIndexType() != boundIndexType) {
+            draw.model->Bind(commandBuffer);
+            boundIndexType = draw.model->GetIndexType();
+        }
+
+        draw.model->Draw(commandBuffer, static_cast<uint32_t>(end - first), static_cast<uint32_t>(first));
+        drawCount++;
+        first = end;
+    }
+
+    return drawCount;
+}
+
+uint32_t SimpleRenderSystem::RenderBatched(VkCommandBuffer commandBuffer,
+                                           FrameRingBuffer& frameRing,
+                                           const VkDescriptorBufferInfo& bufferInfo) {
+    mBatchPipeline->Bind(commandBuffer);
+
+    uint32_t count = mSpriteBatch->Begin(
+        commandBuffer,
+        frameRing,
+        static_cast<uint32_t>(mDraws.size()),
+        [this, &bufferInfo](VkCommandBuffer batchCommandBuffer, TextureHandle texture) {
+            BindTexture(batchCommandBuffer, texture, bufferInfo);
+        });
+
+    if (count < mDraws.size() && !mOverflowLogged) {
+        gCoordinator.LogError("batched rendering: frame ring holds ", count, " of ", mDraws.size(),
+                              " sprites, the rest is not drawn");
+        mOverflowLogged = true;
     }
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto& transform = gCoordinator.GetComponent<Transform>(mDraws[i].entity);
+        auto& renderable = gCoordinator.GetComponent<Renderable>(mDraws[i].entity);
+
+        mSpriteBatch->Draw(mDraws[i].texture,
+                           transform.GetModelMatrix(),
+                           mDraws[i].uvRect,
+                           glm::vec4(renderable.color, renderable.opacity));
+    }
+
+    mSpriteBatch->End();
+    return mSpriteBatch->GetDrawCount();
+}
+
+void SimpleRenderSystem::BindTexture(VkCommandBuffer commandBuffer,
+                                     TextureHandle texture,
+                                     const VkDescriptorBufferInfo& bufferInfo) {
+    if (!mTextureTable) {
+        PushDescriptors(commandBuffer, texture, bufferInfo);
+        return;
+    }
+
+    // the same for the whole draw, so it is dynamically uniform
+    FragmentPushData fragmentPush{};
+    fragmentPush.textureIndex = gResourceManager.GetTextureSlot(texture);
+
+    vkCmdPushConstants(
+        commandBuffer,
+        mPipelineLayout,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+        sizeof(VertexPushData),
+        sizeof(FragmentPushData),
+        &fragmentPush);
+}
+
+void SimpleRenderSystem::UpdateBenchmark(std::chrono::steady_clock::duration recordTime, uint32_t drawCount) {
+    mBenchmark.frames++;
+    mBenchmark.drawCalls += drawCount;
+    mBenchmark.sprites += mDraws.size();
+    mBenchmark.recordTime += recordTime;
+
+    if (mBenchmark.frames < BENCHMARK_FRAMES) {
+        return;
+    }
+
+    auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(mBenchmark.recordTime).count();
+
+    gCoordinator.LogInfo("render benchmark: ", RenderPathName(mRenderPath), " path records ",
+                         mBenchmark.sprites / mBenchmark.frames, " sprites in ",
+                         microseconds / mBenchmark.frames, " us with ",
+                         mBenchmark.drawCalls / mBenchmark.frames, " draws per frame");
+
+    // on to the next path, round and round for as long as the app runs
+    mRenderPath = static_cast<RenderPath>((static_cast<size_t>(mRenderPath) + 1) % RENDER_PATH_COUNT);
+    mBenchmark = {};
+    mBenchmark.enabled = true;
+}
+
+void SimpleRenderSystem::PushDescriptors(VkCommandBuffer commandBuffer,
+                                         TextureHandle texture,
+                                         const VkDescriptorBufferInfo& bufferInfo) {
+    auto imageInfo = gResourceManager.GetTexture(texture)->DescriptorInfo();
+
+    auto descriptorWrites = DescriptorWriter(*mDescriptorSetLayout)
+        .WriteBuffer(0, &bufferInfo)
+        .WriteImage(1, &imageInfo)
+        .GetWrites();
+
+    // attach ubo descriptor writes to command buffer
+    mDevice->vkCmdPushDescriptorSetKHR(
+        commandBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        mPipelineLayout,
+        0,
+        static_cast<uint32_t>(descriptorWrites.size()),
+        descriptorWrites.data()
+    );
 }
@@ -5,18 +5,40 @@
 #include <model.hpp>
 #include <texture.hpp>
 #include <descriptors.hpp>
-#include <buffer.hpp>
+#include <frame_ring_buffer.hpp>
+#include <sprite_batch.hpp>
+#include <bindless_texture_table.hpp>
 
 // std
+#include <array>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <components/renderable.hpp>
 #include <core/system.hpp>
+#include <core/thread_pool.hpp>
+#include <core/io/file_watcher.hpp>
 
 class SimpleRenderSystem : public System {
 
 public:
+    // How entities turn into draw calls
+    enum class RenderPath {
+        // one draw per entity, model matrix and color in push constants
+        PER_DRAW,
+        // one instanced draw per model and texture, per entity data in a
+        // vertex buffer written each frame
+        INSTANCED,
+        // quads transformed on the CPU, one draw per texture, see
+        // SpriteBatch. Every entity is drawn as the unit square
+        BATCHED
+    };
+
+    static constexpr size_t RENDER_PATH_COUNT = 3;
+
     struct Ubo {
         alignas(16) glm::mat4 projection;
         alignas(16) glm::mat4 view;
@@ -24,11 +46,29 @@ public:
 
     struct VertexPushData {
         alignas(16) glm::mat4 model;
+        // (u, v, width, height) of the texture area to map the model onto
+        alignas(16) glm::vec4 uvRect;
     };
 
     struct FragmentPushData {
         alignas(16) glm::vec3 color;
         alignas(16) float opacity;
+        // slot in the bindless texture table, unused by the push descriptor path
+        uint32_t textureIndex;
+    };
+
+    // Per instance vertex data of the instanced path, read at binding 1
+    struct Instance {
+        // columns of the 2D linear part of the model matrix
+        glm::vec4 basis;
+        // translation, z is the depth
+        glm::vec3 position;
+        // color and opacity, unorm8
+        uint32_t color;
+        glm::vec4 uvRect;
+
+        static VkVertexInputBindingDescription GetBindingDescription();
+        static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
     };
 
     SimpleRenderSystem();
@@ -36,20 +76,103 @@ public:
 
     void Init(std::shared_ptr<Device> device, VkRenderPass renderPass);
 
-    void Render(VkCommandBuffer commandBuffer, int frameIndex);
+    // Per frame data goes into frameRing
+    void Render(VkCommandBuffer commandBuffer, FrameRingBuffer& frameRing);
+
+    void SetRenderPath(RenderPath renderPath) { mRenderPath = renderPath; }
+
+    // Times recording for BENCHMARK_FRAMES frames on each render path in
+    // turn and logs the average CPU time and draw count of every path
+    void EnableBenchmark();
+    static constexpr uint32_t BENCHMARK_FRAMES = 300;
+
+    // Watches the shader sources. Edited GLSL is recompiled with glslc on a
+    // background thread and the pipeline is rebuilt from the new SPIR-V at
+    // the start of the next Render, so rebuilding the Shaders target works
+    // as well. Broken shaders keep the current pipeline
+    void EnableHotReload();
 
 private:
+    struct Draw {
+        Entity entity;
+        TextureHandle texture;
+        glm::vec4 uvRect;
+        Model::VertexFormat vertexFormat;
+        Model *model;
+    };
+
     void CreateDescriptorSetLayouts();
-    void CreateUniformBuffers();
     void CreatePipelineLayout();
     void CreatePipeline(VkRenderPass renderPass);
+    void ReloadChangedShaders();
+
+    // each returns the number of draw calls recorded
+    uint32_t RenderPerDraw(VkCommandBuffer commandBuffer, const VkDescriptorBufferInfo& bufferInfo);
+    uint32_t RenderInstanced(VkCommandBuffer commandBuffer,
+                             FrameRingBuffer& frameRing,
+                             const VkDescriptorBufferInfo& bufferInfo);
+    uint32_t RenderBatched(VkCommandBuffer commandBuffer,
+                           FrameRingBuffer& frameRing,
+                           const VkDescriptorBufferInfo& bufferInfo);
+    // The texture and the ubo, for the push descriptor path
+    void PushDescriptors(VkCommandBuffer commandBuffer,
+                         TextureHandle texture,
+                         const VkDescriptorBufferInfo& bufferInfo);
+    // Selects texture for the instanced and batched paths, which take the
+    // color from their vertex data
+    void BindTexture(VkCommandBuffer commandBuffer, TextureHandle texture, const VkDescriptorBufferInfo& bufferInfo);
+    void UpdateBenchmark(std::chrono::steady_clock::duration recordTime, uint32_t drawCount);
+
+    // one per Model::VertexFormat, they differ in vertex input state only
+    using Pipelines = std::array<std::unique_ptr<Pipeline>, Model::VERTEX_FORMAT_COUNT>;
+
+    // replaced pipelines may still be used by frames in flight
+    struct RetiredPipelines {
+        Pipelines pipelines;
+        Pipelines instancedPipelines;
+        std::unique_ptr<Pipeline> batchPipeline;
+        uint64_t releaseFrame;
+    };
 
     std::shared_ptr<Device> mDevice;
 
-    std::unique_ptr<Pipeline> mPipeline;
+    RenderPath mRenderPath = RenderPath::INSTANCED;
+
+    Pipelines mPipelines;
+    Pipelines mInstancedPipelines;
+    // sprite batch vertices have a single format
+    std::unique_ptr<Pipeline> mBatchPipeline;
     VkPipelineLayout mPipelineLayout;
+    VkRenderPass mRenderPass;
+
+    std::vector<RetiredPipelines> mRetiredPipelines;
+    uint64_t mFrame = 0;
+
+    std::unique_ptr<FileWatcher> mShaderWatcher;
+    std::unique_ptr<ThreadPool> mShaderCompiler;
+    // glslc output, empty on success
+    std::vector<std::future<std::string>> mShaderBuilds;
 
     std::unique_ptr<DescriptorSetLayout> mDescriptorSetLayout;
 
-    std::vector<std::unique_ptr<Buffer>> mUboBuffers;
+    // set when the device supports bindless textures, textures are then
+    // selected by index instead of pushed per draw
+    BindlessTextureTable *mTextureTable = nullptr;
+
+    // rebuilt every frame, kept to reuse its storage
+    std::vector<Draw> mDraws;
+    // sprites beyond what the frame ring holds are dropped, said once
+    bool mOverflowLogged = false;
+
+    std::unique_ptr<SpriteBatch> mSpriteBatch;
+
+    struct Benchmark {
+        bool enabled = false;
+        uint32_t frames = 0;
+        uint64_t drawCalls = 0;
+        uint64_t sprites = 0;
+        std::chrono::steady_clock::duration recordTime{};
+    };
+
+    Benchmark mBenchmark;
 };
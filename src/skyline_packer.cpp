@@ -0,0 +1,112 @@
+#include <skyline_packer.hpp>
+
+#include <algorithm>
+#include <limits>
+
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) : mWidth(width), mHeight(height) {
+    Clear();
+}
+
+void SkylinePacker::Clear() {
+    mSkyline.clear();
+    mSkyline.push_back({0, 0, mWidth});
+    mUsedArea = 0;
+}
+
+float SkylinePacker::Occupancy() const {
+    return static_cast<float>(mUsedArea) / (static_cast<float>(mWidth) * mHeight);
+}
+
+std::optional<uint32_t> SkylinePacker::FitAt(size_t index, uint32_t width, uint32_t height) const {
+    uint32_t x = mSkyline[index].x;
+
+    if (x + width > mWidth) {
+        return std::nullopt;
+    }
+
+    // the rectangle rests on the highest segment below it
+    uint32_t y = 0;
+    uint32_t remaining = width;
+
+    for (size_t i = index; remaining > 0; i++) {
+        y = std::max(y, mSkyline[i].y);
+
+        if (y + height > mHeight) {
+            return std::nullopt;
+        }
+
+        remaining -= std::min(remaining, mSkyline[i].width);
+    }
+
+    return y;
+}
+
+std::optional<SkylinePacker::Rect> SkylinePacker::Insert(uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0) {
+        return std::nullopt;
+    }
+
+    size_t bestIndex = mSkyline.size();
+    uint32_t bestTop = std::numeric_limits<uint32_t>::max();
+    uint32_t bestWidth = std::numeric_limits<uint32_t>::max();
+    uint32_t bestY = 0;
+
+    for (size_t i = 0; i < mSkyline.size(); i++) {
+        std::optional<uint32_t> y = FitAt(i, width, height);
+
+        if (!y) {
+            continue;
+        }
+
+        // lowest top edge first, narrower segments break ties to keep wide gaps open
+        uint32_t top = *y + height;
+
+        if (top < bestTop || (top == bestTop && mSkyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestTop = top;
+            bestWidth = mSkyline[i].width;
+            bestY = *y;
+        }
+    }
+
+    if (bestIndex == mSkyline.size()) {
+        return std::nullopt;
+    }
+
+    Rect rect{mSkyline[bestIndex].x, bestY, width, height};
+    mSkyline.insert(mSkyline.begin() + bestIndex, {rect.x, rect.y + height, width});
+
+    // cut the segments now covered by the new one
+    size_t next = bestIndex + 1;
+
+    while (next < mSkyline.size()) {
+        uint32_t covered = rect.x + width;
+
+        if (mSkyline[next].x >= covered) {
+            break;
+        }
+
+        uint32_t overlap = covered - mSkyline[next].x;
+
+        if (overlap < mSkyline[next].width) {
+            mSkyline[next].x += overlap;
+            mSkyline[next].width -= overlap;
+            break;
+        }
+
+        mSkyline.erase(mSkyline.begin() + next);
+    }
+
+    // merge neighbours at the same height
+    for (size_t i = 0; i + 1 < mSkyline.size();) {
+        if (mSkyline[i].y == mSkyline[i + 1].y) {
+            mSkyline[i].width += mSkyline[i + 1].width;
+            mSkyline.erase(mSkyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+
+    mUsedArea += static_cast<uint64_t>(width) * height;
+    return rect;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Packs rectangles into a fixed size area with the skyline bottom-left
+// heuristic. The upper edge of everything placed so far is kept as a list
+// of horizontal segments; a rectangle goes where its top ends up lowest.
+// Insertion is incremental and never moves earlier rectangles, packing a
+// whole set sorted by decreasing height gives tighter results.
+class SkylinePacker {
+public:
+    struct Rect {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    SkylinePacker(uint32_t width, uint32_t height);
+
+    // nullopt when the rectangle does not fit anywhere
+    std::optional<Rect> Insert(uint32_t width, uint32_t height);
+    void Clear();
+
+    // Fraction of the area covered by inserted rectangles
+    float Occupancy() const;
+
+    uint32_t GetWidth() const {
+        return mWidth;
+    }
+
+    uint32_t GetHeight() const {
+        return mHeight;
+    }
+
+private:
+    struct Segment {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    // Lowest y a rectangle of the given width can sit at when its left
+    // edge is at segment index, nullopt if it sticks out of the area
+    std::optional<uint32_t> FitAt(size_t index, uint32_t width, uint32_t height) const;
+
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint64_t mUsedArea = 0;
+
+    std::vector<Segment> mSkyline;
+};
@@ -0,0 +1,163 @@
+#include <sprite_batch.hpp>
+
+#include <glm/gtc/packing.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+
+namespace {
+
+// corners of the unit square in index order, with the texture
+// coordinates the square model has there after the importer flips v
+const std::array<glm::vec2, 4> CORNERS{glm::vec2(-0.5f, -0.5f),
+                                       glm::vec2(0.5f, -0.5f),
+                                       glm::vec2(0.5f, 0.5f),
+                                       glm::vec2(-0.5f, 0.5f)};
+const std::array<glm::vec2, 4> TEX_COORDS{glm::vec2(0.0f, 1.0f),
+                                          glm::vec2(1.0f, 1.0f),
+                                          glm::vec2(1.0f, 0.0f),
+                                          glm::vec2(0.0f, 0.0f)};
+
+}
+
+std::vector<VkVertexInputBindingDescription> SpriteBatch::Vertex::GetBindingDescriptions() {
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding = 0;
+    bindingDescriptions[0].stride = sizeof(SpriteBatch::Vertex);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> SpriteBatch::Vertex::GetAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions(3);
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+    attributeDescriptions[0].offset = offsetof(SpriteBatch::Vertex, position);
+
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributeDescriptions[1].offset = offsetof(SpriteBatch::Vertex, color);
+
+    attributeDescriptions[2].binding = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = VK_FORMAT_R16G16_UNORM;
+    attributeDescriptions[2].offset = offsetof(SpriteBatch::Vertex, texCoord);
+
+    return attributeDescriptions;
+}
+
+SpriteBatch::SpriteBatch(GeometryPool& geometryPool, UploadManager& uploadManager) :
+    mGeometryPool(geometryPool),
+    mUploadManager(uploadManager) {
+    // two triangles per quad, the same for every sprite
+    std::vector<uint16_t> indices;
+    indices.reserve(MAX_SPRITES * 6);
+
+    for (uint32_t i = 0; i < MAX_SPRITES; i++) {
+        uint16_t first = static_cast<uint16_t>(i * 4);
+
+        for (uint16_t corner : {0, 1, 2, 2, 3, 0}) {
+            indices.push_back(static_cast<uint16_t>(first + corner));
+        }
+    }
+
+    mIndices = mGeometryPool.AllocateIndices(indices.data(),
+                                             indices.size() * sizeof(uint16_t),
+                                             sizeof(uint16_t),
+                                             mUploadManager);
+    mIndexUpload = mUploadManager.Flush();
+}
+
+uint32_t SpriteBatch::Begin(VkCommandBuffer commandBuffer,
+                            FrameRingBuffer& frameRing,
+                            uint32_t spriteCount,
+                            TextureBinder bindTexture) {
+    constexpr VkDeviceSize VERTEX_ALIGNMENT = 16;
+    constexpr VkDeviceSize SPRITE_SIZE = 4 * sizeof(Vertex);
+
+    mCommandBuffer = commandBuffer;
+    mBindTexture = std::move(bindTexture);
+    mSpriteCount = 0;
+    mBatchStart = 0;
+    mTexture = {};
+    mBoundTexture = {};
+    mDrawCount = 0;
+
+    if (!mUploadManager.IsComplete(mIndexUpload)) {
+        mCapacity = 0;
+        mVertices = nullptr;
+        return 0;
+    }
+
+    VkDeviceSize available = frameRing.GetFrameSize() - frameRing.GetUsedBytes();
+    VkDeviceSize fits = available > VERTEX_ALIGNMENT ? (available - VERTEX_ALIGNMENT) / SPRITE_SIZE : 0;
+    mCapacity = static_cast<uint32_t>(std::min<VkDeviceSize>(spriteCount, fits));
+
+    if (mCapacity == 0) {
+        mVertices = nullptr;
+        return 0;
+    }
+
+    FrameRingBuffer::Allocation allocation = frameRing.Allocate(mCapacity * SPRITE_SIZE, VERTEX_ALIGNMENT);
+    mVertices = static_cast<Vertex *>(allocation.data);
+
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &allocation.buffer, &allocation.offset);
+    vkCmdBindIndexBuffer(commandBuffer, mGeometryPool.GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
+
+    return mCapacity;
+}
+
+void SpriteBatch::Draw(TextureHandle texture, const glm::mat4& model, const glm::vec4& uvRect, const glm::vec4& color) {
+    if (mSpriteCount > mBatchStart &&
+        (!(texture == mTexture) || mSpriteCount - mBatchStart == MAX_SPRITES)) {
+        Flush();
+    }
+
+    mTexture = texture;
+
+    uint32_t packedColor = glm::packUnorm4x8(color);
+    Vertex *vertex = mVertices + mSpriteCount * 4;
+
+    for (size_t i = 0; i < CORNERS.size(); i++) {
+        glm::vec4 position = model * glm::vec4(CORNERS[i], 0.0f, 1.0f);
+        glm::vec2 texCoord = glm::vec2(uvRect) + TEX_COORDS[i] * glm::vec2(uvRect.z, uvRect.w);
+        uint32_t packedTexCoord = glm::packUnorm2x16(texCoord);
+
+        vertex[i].position = glm::vec3(position);
+        vertex[i].color = packedColor;
+        vertex[i].texCoord[0] = static_cast<uint16_t>(packedTexCoord & 0xffff);
+        vertex[i].texCoord[1] = static_cast<uint16_t>(packedTexCoord >> 16);
+    }
+
+    mSpriteCount++;
+}
+
+void SpriteBatch::End() {
+    if (mSpriteCount > mBatchStart) {
+        Flush();
+    }
+
+    mCommandBuffer = VK_NULL_HANDLE;
+    mBindTexture = nullptr;
+}
+
+void SpriteBatch::Flush() {
+    // batches split at MAX_SPRITES keep their texture
+    if (mDrawCount == 0 || !(mTexture == mBoundTexture)) {
+        mBindTexture(mCommandBuffer, mTexture);
+        mBoundTexture = mTexture;
+    }
+
+    // indices restart at 0 for every batch, the vertex offset moves them
+    // to the batch's vertices
+    uint32_t count = mSpriteCount - mBatchStart;
+    uint32_t firstIndex = static_cast<uint32_t>(mIndices.offset / sizeof(uint16_t));
+    vkCmdDrawIndexed(mCommandBuffer, count * 6, 1, firstIndex, static_cast<int32_t>(mBatchStart * 4), 0);
+
+    mBatchStart = mSpriteCount;
+    mDrawCount++;
+}
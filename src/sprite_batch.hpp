@@ -0,0 +1,94 @@
+#pragma once
+
+#include <device.hpp>
+#include <frame_ring_buffer.hpp>
+#include <geometry_pool.hpp>
+#include <upload_manager.hpp>
+#include <resource_handle.hpp>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Draws sprites as quads transformed on the CPU. Vertices are written
+// straight into the frame ring, one allocation per frame, and sprites in a
+// row with the same texture become one indexed draw over static indices,
+// kept in the geometry pool and shared by every batch. A batch is flushed when the texture
+// changes, when it reaches MAX_SPRITES and at End. Sprites of any size and
+// atlas region batch together, which suits many small sprites with little
+// state to switch between them.
+class SpriteBatch {
+public:
+    // per draw, four vertices per sprite keep indices within 16 bits
+    static constexpr uint32_t MAX_SPRITES = 16384;
+
+    // Model::Vertex's attribute locations, pre-transformed and packed
+    struct Vertex {
+        glm::vec3 position;
+        // color and opacity, unorm8
+        uint32_t color;
+        // unorm16, precise enough for texel edges of large atlas pages
+        uint16_t texCoord[2];
+
+        static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+        static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+    };
+
+    // Makes texture the one the following draws sample
+    using TextureBinder = std::function<void(VkCommandBuffer commandBuffer, TextureHandle texture)>;
+
+    // Uploads the indices into geometryPool, batches draw nothing until
+    // the upload has completed. The range is never freed, render systems
+    // are torn down after the resource manager that owns the pool
+    SpriteBatch(GeometryPool& geometryPool, UploadManager& uploadManager);
+
+    SpriteBatch(const SpriteBatch &) = delete;
+    SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+    // Reserves vertices for up to spriteCount sprites in frameRing and
+    // binds them with the index buffer. The pipeline is the caller's to
+    // bind, switching it means End and Begin again. Returns how many
+    // sprites fit, Draw must not be called more often. Zero while the
+    // indices are still uploading
+    uint32_t Begin(VkCommandBuffer commandBuffer,
+                   FrameRingBuffer& frameRing,
+                   uint32_t spriteCount,
+                   TextureBinder bindTexture);
+
+    // The unit square centered on the origin, like the square model,
+    // transformed by model. uvRect is (u, v, width, height)
+    void Draw(TextureHandle texture, const glm::mat4& model, const glm::vec4& uvRect, const glm::vec4& color);
+
+    // Draws what is still queued
+    void End();
+
+    // vkCmdDrawIndexed calls since Begin
+    uint32_t GetDrawCount() const { return mDrawCount; }
+
+private:
+    void Flush();
+
+    GeometryPool& mGeometryPool;
+    UploadManager& mUploadManager;
+    GeometryPool::Range mIndices;
+    UploadManager::BatchId mIndexUpload;
+
+    VkCommandBuffer mCommandBuffer = VK_NULL_HANDLE;
+    TextureBinder mBindTexture;
+
+    Vertex *mVertices = nullptr;
+    uint32_t mCapacity = 0;
+    // sprites written since Begin, the current batch starts at mBatchStart
+    uint32_t mSpriteCount = 0;
+    uint32_t mBatchStart = 0;
+    TextureHandle mTexture{};
+    TextureHandle mBoundTexture{};
+
+    uint32_t mDrawCount = 0;
+};
@@ -53,7 +53,7 @@ SwapChain::~SwapChain() {
     for (int i = 0; i < mDepthImages.size(); i++) {
         vkDestroyImageView(mDevice->GetDevice(), mDepthImageViews[i], nullptr);
         vkDestroyImage(mDevice->GetDevice(), mDepthImages[i], nullptr);
-        vkFreeMemory(mDevice->GetDevice(), mDepthImageMemorys[i], nullptr);
+        mDevice->GetAllocator().Free(mDepthImageMemorys[i]);
     }
 
     for (auto framebuffer : mSwapChainFramebuffers) {
@@ -336,7 +336,8 @@ void SwapChain::CreateDepthResources() {
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
             mDepthImages[i],
-            mDepthImageMemorys[i]);
+            mDepthImageMemorys[i],
+            MemoryCategory::SWAPCHAIN);
 
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
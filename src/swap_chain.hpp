@@ -67,7 +67,7 @@ private:
     VkRenderPass mRenderPass;
 
     std::vector<VkImage> mDepthImages;
-    std::vector<VkDeviceMemory> mDepthImageMemorys;
+    std::vector<MemoryAllocator::Allocation> mDepthImageMemorys;
     std::vector<VkImageView> mDepthImageViews;
     std::vector<VkImage> mSwapChainImages;
     std::vector<VkImageView> mSwapChainImageViews;
@@ -4,6 +4,7 @@
 #include <components/renderable.hpp>
 #include <core/coordinator.hpp>
 
+#include <algorithm>
 #include <random>
 
 extern Coordinator gCoordinator;
@@ -11,37 +12,56 @@ extern Coordinator gCoordinator;
 class LsdSystem : public System {
 
 public:
-    void Update(float dt) {
-        std::random_device rdev{};
-        std::default_random_engine generator{rdev()};
-        std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+    void Init() {
+        gCoordinator.AddListener(METHOD_LISTENER(Events::Lsd::Transition::ID, LsdSystem::OnTransition));
+
+        mTransitionTimer = gCoordinator.ScheduleRepeating(transitionTime,
+                                                          transitionTime,
+                                                          Events::Lsd::Transition::ID);
+        mTransitionStart = gCoordinator.GetTime();
+    }
+
+    void Update([[maybe_unused]] float dt) {
+        Resize();
 
+        float t = std::clamp((gCoordinator.GetTime() - mTransitionStart) / transitionTime, 0.0f, 1.0f);
         int i = 0;
 
         for (auto& entity : mEntities) {
             auto& renderable = gCoordinator.GetComponent<Renderable>(entity);
 
-            spentTimes[i] += dt;
+            renderable.color = originalColors[i] * (1.0f - t) + targetColors[i] * t;
 
-            if (spentTimes[i] >= transitionTime) {
-                spentTimes[i] = 0.f;
+            i++;
+        }
+    }
 
-                originalColors[i] = targetColors[i];
-                targetColors[i] = glm::vec3(dist(generator), dist(generator), dist(generator));
-            } else {
-                float t = spentTimes[i] / transitionTime;
+private:
+    void OnTransition([[maybe_unused]] Event const& event) {
+        Resize();
 
-                renderable.color = originalColors[i] * (1.0f - t) + targetColors[i] * t;
-            }
+        std::uniform_real_distribution<float> dist{0.0f, 1.0f};
 
+        for (size_t i = 0; i < targetColors.size(); i++) {
+            originalColors[i] = targetColors[i];
+            targetColors[i] = glm::vec3(dist(mGenerator), dist(mGenerator), dist(mGenerator));
+        }
 
-            i++;
+        mTransitionStart = gCoordinator.GetTime();
+    }
+
+    void Resize() {
+        if (targetColors.size() < mEntities.size()) {
+            originalColors.resize(mEntities.size(), glm::vec3(1.0f));
+            targetColors.resize(mEntities.size(), glm::vec3(0.0f));
         }
     }
 
-private:
     const float transitionTime = .5f;
-    std::vector<float> spentTimes{0.0f, 0.0f};
-    std::vector<glm::vec3> originalColors{glm::vec3(1.0f), glm::vec3(1.0f)};
-    std::vector<glm::vec3> targetColors{glm::vec3(0.f), glm::vec3(0.f)};
-};
\ No newline at end of file
+    TimerHandle mTransitionTimer;
+    float mTransitionStart = 0.0f;
+
+    std::default_random_engine mGenerator{std::random_device{}()};
+    std::vector<glm::vec3> originalColors;
+    std::vector<glm::vec3> targetColors;
+};
@@ -3,28 +3,55 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <cooked_texture_format.hpp>
+#include <mip_generator.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <iostream>
 
-// TODO add customization options for different image samplers and views
+// TODO add customization options for different image views
 // TODO do something about device shared_ptr (maybe let resource manager
 // create all required vkobjects)
 
-Texture::Texture(std::shared_ptr<Device> device, const std::string& filePath) :
-                 mDevice(device) {    
-    CreateImage(filePath);
-    CreateImageView();
-    CreateSampler();
+Texture::Texture(std::shared_ptr<Device> device, const ImageData& image, UploadManager& uploadManager) :
+                 Texture(device, image, [&image](void *dst) {
+                     std::memcpy(dst, image.pixels.get(), static_cast<size_t>(image.Size()));
+                 }, uploadManager) {
+}
+
+Texture::Texture(std::shared_ptr<Device> device,
+                 const ImageData& image,
+                 const UploadManager::StagingWriter& write,
+                 UploadManager& uploadManager) :
+                 mDevice(device) {
+    // blits fill in whatever the image data lacks, otherwise sample only
+    // the levels that were provided
+    mMipLevels = MipGenerator::MipLevelCount(image.width, image.height);
+
+    if (!image.mipmapped || !mDevice->SupportsLinearBlit(image.format)) {
+        mMipLevels = std::min(mMipLevels, static_cast<uint32_t>(image.levels.size()));
+    }
+
+    CreateImage(image, write, uploadManager);
+    CreateImageView(image.format);
+    CreateSampler(image.sampler);
 }
 
 Texture::~Texture() {
-    vkDestroySampler(mDevice->GetDevice(), mSampler, nullptr);
     vkDestroyImageView(mDevice->GetDevice(), mImageView, nullptr);
     vkDestroyImage(mDevice->GetDevice(), mImage, nullptr);
-    vkFreeMemory(mDevice->GetDevice(), mImageMemory, nullptr);
+    mDevice->GetAllocator().Free(mImageMemory);
 }
 
-void Texture::CreateImage(const std::string& filePath) {
+Texture::ImageData Texture::ImageData::Load(const std::string& filePath) {
+    if (filePath.ends_with(CookedTexture::EXTENSION)) {
+        return LoadCooked(filePath);
+    }
+
     int texWidth;
     int texHeight;
     int texChannels;
@@ -35,93 +62,232 @@ void Texture::CreateImage(const std::string& filePath) {
                                 &texHeight,
                                 &texChannels,
                                 STBI_rgb_alpha);
-    
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
 
     if (!pixels) {
         throw std::runtime_error("failed to load texture: " + filePath);
     }
 
-    // create staging buffer
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
+    ImageData image;
+    image.width = static_cast<uint32_t>(texWidth);
+    image.height = static_cast<uint32_t>(texHeight);
+    image.pixels = {pixels, stbi_image_free};
+    image.levels.push_back({0, image.width, image.height});
+
+    return image;
+}
+
+Texture::ImageData Texture::ImageData::LoadCooked(const std::string& filePath) {
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file{std::fopen(filePath.c_str(), "rb"), std::fclose};
+
+    if (!file) {
+        throw std::runtime_error("failed to open cooked texture: " + filePath);
+    }
+
+    CookedTexture::FileHeader header;
+
+    if (std::fread(&header, sizeof(header), 1, file.get()) != 1 ||
+        header.levelCount > MipGenerator::MipLevelCount(header.width, header.height)) {
+        throw std::runtime_error("invalid cooked texture: " + filePath);
+    }
+
+    std::vector<CookedTexture::LevelEntry> entries(header.levelCount);
 
-    mDevice->CreateBuffer(imageSize,
-                          VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                          stagingBuffer,
-                          stagingBufferMemory);
+    if (std::fread(entries.data(), sizeof(CookedTexture::LevelEntry), entries.size(), file.get()) != entries.size()) {
+        throw std::runtime_error("truncated cooked texture: " + filePath);
+    }
+
+    ImageData image = FromCookedHeader(header, entries.data(), filePath);
+
+    // the pixels are already in their final layout, one read and no decode
+    auto *data = static_cast<unsigned char *>(std::malloc(header.dataSize));
+
+    if (!data) {
+        throw std::runtime_error("failed to allocate cooked texture: " + filePath);
+    }
 
-    // copy data to buffer
-    void *data;
-    vkMapMemory(mDevice->GetDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(mDevice->GetDevice(), stagingBufferMemory);
+    image.pixels = {data, std::free};
 
-    // free stbi image
-    stbi_image_free(pixels);
+    if (std::fread(data, 1, header.dataSize, file.get()) != header.dataSize) {
+        throw std::runtime_error("truncated cooked texture: " + filePath);
+    }
+
+    return image;
+}
+
+Texture::ImageData Texture::ImageData::Load(const std::vector<unsigned char>& contents, const std::string& source) {
+    if (!source.ends_with(CookedTexture::EXTENSION)) {
+        int texWidth;
+        int texHeight;
+        int texChannels;
+
+        stbi_uc *pixels = stbi_load_from_memory(contents.data(),
+                                                static_cast<int>(contents.size()),
+                                                &texWidth,
+                                                &texHeight,
+                                                &texChannels,
+                                                STBI_rgb_alpha);
+
+        if (!pixels) {
+            throw std::runtime_error("failed to load texture: " + source);
+        }
+
+        ImageData image;
+        image.width = static_cast<uint32_t>(texWidth);
+        image.height = static_cast<uint32_t>(texHeight);
+        image.pixels = {pixels, stbi_image_free};
+        image.levels.push_back({0, image.width, image.height});
+
+        return image;
+    }
+
+    CookedTexture::FileHeader header;
+
+    if (contents.size() < sizeof(header)) {
+        throw std::runtime_error("invalid cooked texture: " + source);
+    }
+
+    std::memcpy(&header, contents.data(), sizeof(header));
+
+    size_t levelsSize = header.levelCount * sizeof(CookedTexture::LevelEntry);
+
+    if (header.levelCount > MipGenerator::MipLevelCount(header.width, header.height) ||
+        contents.size() - sizeof(header) < levelsSize ||
+        contents.size() - sizeof(header) - levelsSize < header.dataSize) {
+        throw std::runtime_error("truncated cooked texture: " + source);
+    }
+
+    std::vector<CookedTexture::LevelEntry> entries(header.levelCount);
+    std::memcpy(entries.data(), contents.data() + sizeof(header), levelsSize);
+
+    ImageData image = FromCookedHeader(header, entries.data(), source);
+
+    auto *data = static_cast<unsigned char *>(std::malloc(header.dataSize));
+
+    if (!data) {
+        throw std::runtime_error("failed to allocate cooked texture: " + source);
+    }
+
+    image.pixels = {data, std::free};
+    std::memcpy(data, contents.data() + sizeof(header) + levelsSize, header.dataSize);
+
+    return image;
+}
+
+Texture::ImageData Texture::ImageData::FromCookedHeader(const CookedTexture::FileHeader& header,
+                                                        const CookedTexture::LevelEntry *entries,
+                                                        const std::string& source) {
+    if (header.magic != CookedTexture::MAGIC ||
+        header.version != CookedTexture::VERSION ||
+        header.levelCount == 0 ||
+        header.levelCount > MipGenerator::MipLevelCount(header.width, header.height)) {
+        throw std::runtime_error("invalid cooked texture: " + source);
+    }
+
+    static_assert(CookedTexture::FORMAT_R8G8B8A8_SRGB == VK_FORMAT_R8G8B8A8_SRGB);
+
+    if (header.format != CookedTexture::FORMAT_R8G8B8A8_SRGB) {
+        throw std::runtime_error("unsupported cooked texture format: " + source);
+    }
+
+    ImageData image;
+    image.width = header.width;
+    image.height = header.height;
+    image.format = static_cast<VkFormat>(header.format);
+
+    for (uint32_t level = 0; level < header.levelCount; level++) {
+        const CookedTexture::LevelEntry& entry = entries[level];
+        VkDeviceSize levelSize = static_cast<VkDeviceSize>(entry.width) * entry.height * 4;
+
+        if (entry.offset + levelSize > header.dataSize) {
+            throw std::runtime_error("invalid cooked texture: " + source);
+        }
+
+        image.levels.push_back({entry.offset, entry.width, entry.height});
+    }
+
+    return image;
+}
+
+VkDeviceSize Texture::ImageData::Size() const {
+    const UploadManager::ImageLevel& last = levels.back();
+    return last.offset + static_cast<VkDeviceSize>(last.width) * last.height * 4;
+}
+
+void Texture::ImageData::GenerateMips() {
+    uint32_t mipLevels = MipGenerator::MipLevelCount(width, height);
+
+    if (levels.size() >= mipLevels) {
+        return;
+    }
+
+    // lay out the whole chain, then copy the provided levels over
+    std::vector<UploadManager::ImageLevel> chain(mipLevels);
+    VkDeviceSize offset = 0;
+
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        chain[level] = {offset, std::max(1u, width >> level), std::max(1u, height >> level)};
+        offset += static_cast<VkDeviceSize>(chain[level].width) * chain[level].height * 4;
+    }
+
+    auto *data = static_cast<unsigned char *>(std::malloc(offset));
+
+    if (!data) {
+        throw std::runtime_error("failed to allocate mip chain");
+    }
+
+    std::memcpy(data, pixels.get(), Size());
+
+    for (uint32_t level = static_cast<uint32_t>(levels.size()); level < mipLevels; level++) {
+        const UploadManager::ImageLevel& src = chain[level - 1];
+        MipGenerator::DownsampleSrgbRgba8(data + src.offset, src.width, src.height, data + chain[level].offset);
+    }
+
+    pixels = {data, std::free};
+    levels = std::move(chain);
+}
+
+void Texture::CreateImage(const ImageData& image, const UploadManager::StagingWriter& write, UploadManager& uploadManager) {
+    bool generateMips = image.levels.size() < mMipLevels;
 
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
-    imageInfo.extent.width = static_cast<uint32_t>(texWidth);
-    imageInfo.extent.height = static_cast<uint32_t>(texHeight);
+    imageInfo.extent.width = image.width;
+    imageInfo.extent.height = image.height;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mMipLevels;
     imageInfo.arrayLayers = 1;
-    imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    imageInfo.format = image.format;
     imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
     imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
     imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+    if (generateMips) {
+        imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
     imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.flags = 0; // optional
 
-    if (vkCreateImage(mDevice->GetDevice(), &imageInfo, nullptr, &mImage) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create image");
-    }
-
-    // allocate memory for image
-    VkMemoryRequirements memRequirements;
-    vkGetImageMemoryRequirements(mDevice->GetDevice(), mImage, &memRequirements);
-
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = mDevice->FindMemoryType(memRequirements.memoryTypeBits,
-                                                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    // sub-allocated from a shared block unless the image is large
+    mDevice->CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mImage, mImageMemory, MemoryCategory::TEXTURE);
+    mMemorySize = mImageMemory.size;
 
-    if (vkAllocateMemory(mDevice->GetDevice(), &allocInfo, nullptr, &mImageMemory) != VK_SUCCESS) {
-        throw std::runtime_error("failed to allocate image memory");
-    }
-
-    vkBindImageMemory(mDevice->GetDevice(), mImage, mImageMemory, 0);
-
-    // copy staging buffer to image
-    mDevice->TransitionImageLayout(mImage,
-                                   VK_FORMAT_R8G8B8A8_SRGB,
-                                   VK_IMAGE_LAYOUT_UNDEFINED,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    std::vector<UploadManager::ImageLevel> levels(image.levels.begin(),
+                                                  image.levels.begin() + std::min<size_t>(image.levels.size(), mMipLevels));
 
-    mDevice->CopyBufferToImage(stagingBuffer, mImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1);
-    mDevice->TransitionImageLayout(mImage,
-                                   VK_FORMAT_R8G8B8A8_SRGB,
-                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-    vkDestroyBuffer(mDevice->GetDevice(), stagingBuffer, nullptr);
-    vkFreeMemory(mDevice->GetDevice(), stagingBufferMemory, nullptr);
+    uploadManager.UploadImage(mImage, image.format, mMipLevels, levels, image.Size(), write);
 }
 
-void Texture::CreateImageView() {
+void Texture::CreateImageView(VkFormat format) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = mImage;
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mMipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
@@ -130,27 +296,7 @@ void Texture::CreateImageView() {
     }
 }
 
-void Texture::CreateSampler() {
-    VkSamplerCreateInfo samplerInfo{};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_TRUE;
-    samplerInfo.maxAnisotropy = mDevice->properties.limits.maxSamplerAnisotropy;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.mipLodBias = 0.0f;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
-
-    if (vkCreateSampler(mDevice->GetDevice(), &samplerInfo, nullptr, &mSampler) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create texture sampler");
-    }
+void Texture::CreateSampler(const SamplerSettings& settings) {
+    mSampler = mDevice->GetSamplerCache().Acquire(settings);
 }
 
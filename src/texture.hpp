@@ -1,34 +1,88 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 #include <vulkan/vulkan.h>
 
+#include <cooked_texture_format.hpp>
 #include <device.hpp>
+#include <sampler_cache.hpp>
+#include <upload_manager.hpp>
 
 class Texture {
 
 public:
-    Texture(std::shared_ptr<Device> device, const std::string& filePath);
+    // Decoded RGBA8 pixels, mip levels packed one after another. Loading
+    // touches no Vulkan state, so it can run on any thread.
+    struct ImageData {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+        std::unique_ptr<unsigned char, void (*)(void *)> pixels{nullptr, nullptr};
+        std::vector<UploadManager::ImageLevel> levels;
+        // false limits the texture to the provided levels, for atlases whose
+        // sprites would bleed into each other in lower mips
+        bool mipmapped = true;
+        SamplerSettings sampler;
+
+        VkDeviceSize Size() const;
+
+        // Fills in the rest of the mip chain on the CPU, for devices that
+        // cannot blit the format
+        void GenerateMips();
+
+        // Decodes an image file, or reads a cooked .vkft blob as is
+        static ImageData Load(const std::string& filePath);
+        static ImageData LoadCooked(const std::string& filePath);
+        // Same for file contents the caller already read, source is only
+        // used to tell cooked blobs apart and in errors
+        static ImageData Load(const std::vector<unsigned char>& contents, const std::string& source);
+
+        // Extent, format and levels of a cooked texture without its pixels
+        static ImageData FromCookedHeader(const CookedTexture::FileHeader& header,
+                                          const CookedTexture::LevelEntry *entries,
+                                          const std::string& source);
+    };
+
+    // The pixels are copied into the upload manager right away, the texture
+    // can be sampled by work submitted after its next Flush
+    Texture(std::shared_ptr<Device> device, const ImageData& image, UploadManager& uploadManager);
+    // Pixels are produced by write straight into staging memory, image only
+    // describes their layout
+    Texture(std::shared_ptr<Device> device,
+            const ImageData& image,
+            const UploadManager::StagingWriter& write,
+            UploadManager& uploadManager);
     ~Texture();
 
     VkDescriptorImageInfo DescriptorInfo() const {
         VkDescriptorImageInfo imageInfo{};
         imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
         imageInfo.imageView = mImageView;
-        imageInfo.sampler = mSampler;
+        imageInfo.sampler = *mSampler;
 
         return imageInfo;
     }
 
+    // Device memory backing the image
+    VkDeviceSize GetMemorySize() const {
+        return mMemorySize;
+    }
+
 private:
-    void CreateImage(const std::string& filePath);
-    void CreateImageView();
-    void CreateSampler();
+    void CreateImage(const ImageData& image, const UploadManager::StagingWriter& write, UploadManager& uploadManager);
+    void CreateImageView(VkFormat format);
+    void CreateSampler(const SamplerSettings& settings);
 
     std::shared_ptr<Device> mDevice;
 
+    uint32_t mMipLevels;
+
     VkImage mImage;
-    VkDeviceMemory mImageMemory;
+    MemoryAllocator::Allocation mImageMemory;
+    VkDeviceSize mMemorySize;
     VkImageView mImageView;
-    VkSampler mSampler;
+    // shared with every texture using the same settings
+    SamplerCache::SamplerRef mSampler;
 };
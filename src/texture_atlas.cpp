@@ -0,0 +1,211 @@
+#include <texture_atlas.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+class Sprite {
+public:
+    uint32_t page;
+    uint32_t width;
+    uint32_t height;
+    std::vector<unsigned char> pixels;
+
+    // gutter included
+    SkylinePacker::Rect rect;
+
+    bool published = false;
+    SkylinePacker::Rect publishedRect;
+};
+
+TextureAtlas::TextureAtlas(uint32_t pageSize) : mPageSize(pageSize) {
+
+}
+
+TextureAtlas::~TextureAtlas() {
+
+}
+
+SpriteHandle TextureAtlas::Insert(const unsigned char *pixels, uint32_t width, uint32_t height) {
+    uint32_t paddedWidth = width + 2 * GUTTER;
+    uint32_t paddedHeight = height + 2 * GUTTER;
+
+    if (width == 0 || height == 0 || paddedWidth > mPageSize || paddedHeight > mPageSize) {
+        throw std::invalid_argument("sprite of " + std::to_string(width) + "x" + std::to_string(height) +
+                                    " does not fit an atlas page");
+    }
+
+    auto sprite = std::make_unique<Sprite>();
+    sprite->width = width;
+    sprite->height = height;
+    sprite->pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+    std::optional<SkylinePacker::Rect> rect;
+    uint32_t pageIndex = 0;
+
+    // existing free space first, then repacking, then a new page
+    for (pageIndex = 0; pageIndex < mPages.size(); pageIndex++) {
+        rect = mPages[pageIndex].packer.Insert(paddedWidth, paddedHeight);
+
+        if (rect) {
+            break;
+        }
+    }
+
+    if (!rect) {
+        for (pageIndex = 0; pageIndex < mPages.size(); pageIndex++) {
+            SkylinePacker::Rect repacked;
+
+            if (Repack(mPages[pageIndex], paddedWidth, paddedHeight, repacked)) {
+                rect = repacked;
+                break;
+            }
+        }
+    }
+
+    if (!rect) {
+        pageIndex = static_cast<uint32_t>(mPages.size());
+        mPages.push_back({SkylinePacker(mPageSize, mPageSize),
+                          std::vector<unsigned char>(static_cast<size_t>(mPageSize) * mPageSize * 4, 0),
+                          {},
+                          {},
+                          false});
+
+        rect = mPages[pageIndex].packer.Insert(paddedWidth, paddedHeight);
+    }
+
+    Page& page = mPages[pageIndex];
+
+    sprite->page = pageIndex;
+    sprite->rect = *rect;
+    Blit(page, *sprite);
+
+    SpriteHandle handle = mSprites.Insert(std::move(sprite));
+    page.sprites.push_back(handle);
+    page.dirty = true;
+
+    return handle;
+}
+
+bool TextureAtlas::Repack(Page& page, uint32_t width, uint32_t height, SkylinePacker::Rect& rect) {
+    // the new sprite takes part as an invalid handle
+    std::vector<SpriteHandle> order = page.sprites;
+    order.push_back(SpriteHandle{});
+
+    auto paddedHeight = [&](SpriteHandle handle) {
+        return handle.IsValid() ? mSprites.Get(handle)->rect.height : height;
+    };
+
+    std::stable_sort(order.begin(), order.end(), [&](SpriteHandle a, SpriteHandle b) {
+        return paddedHeight(a) > paddedHeight(b);
+    });
+
+    SkylinePacker packer(mPageSize, mPageSize);
+    std::vector<SkylinePacker::Rect> rects;
+
+    for (SpriteHandle handle : order) {
+        uint32_t spriteWidth = handle.IsValid() ? mSprites.Get(handle)->rect.width : width;
+        std::optional<SkylinePacker::Rect> placed = packer.Insert(spriteWidth, paddedHeight(handle));
+
+        if (!placed) {
+            return false;
+        }
+
+        rects.push_back(*placed);
+    }
+
+    page.packer = packer;
+    std::fill(page.pixels.begin(), page.pixels.end(), 0);
+
+    for (size_t i = 0; i < order.size(); i++) {
+        if (!order[i].IsValid()) {
+            rect = rects[i];
+            continue;
+        }
+
+        Sprite *sprite = mSprites.Get(order[i]);
+        sprite->rect = rects[i];
+        Blit(page, *sprite);
+    }
+
+    return true;
+}
+
+void TextureAtlas::Blit(Page& page, const Sprite& sprite) {
+    const size_t rowSize = static_cast<size_t>(sprite.width) * 4;
+
+    for (uint32_t y = 0; y < sprite.rect.height; y++) {
+        // gutter rows and columns repeat the nearest border texel
+        uint32_t srcY = std::clamp(y, GUTTER, sprite.height + GUTTER - 1) - GUTTER;
+        const unsigned char *src = sprite.pixels.data() + srcY * rowSize;
+        unsigned char *dst = page.pixels.data() +
+                             ((static_cast<size_t>(sprite.rect.y) + y) * mPageSize + sprite.rect.x) * 4;
+
+        for (uint32_t x = 0; x < GUTTER; x++) {
+            std::memcpy(dst + x * 4, src, 4);
+            std::memcpy(dst + (GUTTER + sprite.width + x) * 4, src + rowSize - 4, 4);
+        }
+
+        std::memcpy(dst + GUTTER * 4, src, rowSize);
+    }
+}
+
+bool TextureAtlas::IsPublished(SpriteHandle sprite) const {
+    return mSprites.Contains(sprite) && mSprites.Get(sprite)->published;
+}
+
+AtlasRegion TextureAtlas::GetRegion(SpriteHandle handle) const {
+    const Sprite *sprite = mSprites.Get(handle);
+    const SkylinePacker::Rect& rect = sprite->publishedRect;
+
+    float scale = 1.0f / static_cast<float>(mPageSize);
+
+    return {mPages[sprite->page].texture,
+            glm::vec4((rect.x + GUTTER) * scale,
+                      (rect.y + GUTTER) * scale,
+                      sprite->width * scale,
+                      sprite->height * scale)};
+}
+
+std::vector<uint32_t> TextureAtlas::GetDirtyPages() const {
+    std::vector<uint32_t> pages;
+
+    for (uint32_t i = 0; i < mPages.size(); i++) {
+        if (mPages[i].dirty) {
+            pages.push_back(i);
+        }
+    }
+
+    return pages;
+}
+
+TextureAtlas::PageSnapshot TextureAtlas::TakeSnapshot(uint32_t pageIndex) {
+    Page& page = mPages[pageIndex];
+    page.dirty = false;
+
+    PageSnapshot snapshot{pageIndex, {}};
+
+    for (SpriteHandle handle : page.sprites) {
+        snapshot.rects.emplace_back(handle, mSprites.Get(handle)->rect);
+    }
+
+    return snapshot;
+}
+
+const unsigned char *TextureAtlas::GetPagePixels(uint32_t page) const {
+    return mPages[page].pixels.data();
+}
+
+TextureHandle TextureAtlas::Publish(const PageSnapshot& snapshot, TextureHandle texture) {
+    for (const auto& [handle, rect] : snapshot.rects) {
+        Sprite *sprite = mSprites.Get(handle);
+        sprite->publishedRect = rect;
+        sprite->published = true;
+    }
+
+    TextureHandle previous = mPages[snapshot.page].texture;
+    mPages[snapshot.page].texture = texture;
+
+    return previous;
+}
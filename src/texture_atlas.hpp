@@ -0,0 +1,88 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <resource_handle.hpp>
+#include <skyline_packer.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Sprite;
+using SpriteHandle = ResourceHandle<Sprite>;
+
+// Where a sprite can be sampled: a page texture and the sprite's rectangle
+// in it as (u, v, width, height) in normalized coordinates
+struct AtlasRegion {
+    TextureHandle page;
+    glm::vec4 uvRect;
+};
+
+// CPU side of the sprite atlas. Sprite pixels are packed into a few large
+// RGBA8 pages that are kept in memory; the ResourceManager uploads dirty
+// pages as whole textures and publishes them once the upload completes.
+// Until then sprites keep the region of the previous upload, so packing
+// never has to synchronize with frames still sampling a page.
+//
+// Sprites are inserted incrementally. When no page has room the fullest
+// candidate is repacked from scratch, tallest sprites first, and only if
+// that still fails a new page is opened. Sprites never change pages.
+class TextureAtlas {
+public:
+    static constexpr uint32_t DEFAULT_PAGE_SIZE = 2048;
+    // border texels are repeated into the gutter so filtering at the edge
+    // of a sprite never picks up its neighbours
+    static constexpr uint32_t GUTTER = 1;
+
+    // Pixels of a page as they were when it was last handed out for upload,
+    // with the rectangles sprites had at that point
+    struct PageSnapshot {
+        uint32_t page;
+        std::vector<std::pair<SpriteHandle, SkylinePacker::Rect>> rects;
+    };
+
+    explicit TextureAtlas(uint32_t pageSize = DEFAULT_PAGE_SIZE);
+    ~TextureAtlas();
+
+    // pixels are width * height RGBA8 texels, copied into the atlas
+    SpriteHandle Insert(const unsigned char *pixels, uint32_t width, uint32_t height);
+
+    // False until a page upload containing the sprite was published
+    bool IsPublished(SpriteHandle sprite) const;
+    AtlasRegion GetRegion(SpriteHandle sprite) const;
+
+    // Pages changed since their last snapshot. Taking a snapshot clears the
+    // dirty flag, the page pixels stay valid until the next Insert.
+    std::vector<uint32_t> GetDirtyPages() const;
+    PageSnapshot TakeSnapshot(uint32_t page);
+    const unsigned char *GetPagePixels(uint32_t page) const;
+
+    // Makes texture the page texture and the snapshot rectangles the
+    // sprites' regions. Returns the texture it replaces, if any
+    TextureHandle Publish(const PageSnapshot& snapshot, TextureHandle texture);
+
+    uint32_t GetPageSize() const {
+        return mPageSize;
+    }
+
+private:
+    struct Page {
+        SkylinePacker packer;
+        std::vector<unsigned char> pixels;
+        std::vector<SpriteHandle> sprites;
+        TextureHandle texture;
+        bool dirty = false;
+    };
+
+    bool Repack(Page& page, uint32_t width, uint32_t height, SkylinePacker::Rect& rect);
+    void Blit(Page& page, const Sprite& sprite);
+
+    uint32_t mPageSize;
+
+    std::vector<Page> mPages;
+    ResourcePool<Sprite> mSprites;
+};
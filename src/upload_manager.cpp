@@ -0,0 +1,605 @@
+#include <upload_manager.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}
+
+UploadManager::UploadManager(std::shared_ptr<Device> device, VkDeviceSize stagingSize) :
+                             mDevice(device),
+                             mDedicatedTransfer(device->HasDedicatedTransferQueue()),
+                             mStagingSize(stagingSize) {
+    mStagingAlignment = std::max<VkDeviceSize>(16, mDevice->properties.limits.optimalBufferCopyOffsetAlignment);
+
+    mStagingBuffer = std::make_unique<Buffer>(mDevice,
+                                              mStagingSize,
+                                              1,
+                                              VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                              1,
+                                              false,
+                                              MemoryCategory::STAGING);
+
+    // stays mapped for the lifetime of the manager
+    if (mStagingBuffer->Map() != VK_SUCCESS) {
+        throw std::runtime_error("failed to map staging ring");
+    }
+
+    mStagingMemory = static_cast<char *>(mStagingBuffer->GetMappedMemory());
+}
+
+UploadManager::~UploadManager() {
+    Flush();
+
+    while (!mInFlightBatches.empty()) {
+        RetireBatches(true);
+    }
+
+    for (auto& batch : mFreeBatches) {
+        vkDestroyFence(mDevice->GetDevice(), batch.fence, nullptr);
+        vkFreeCommandBuffers(mDevice->GetDevice(), mDevice->GetTransferCommandPool(), 1, &batch.commandBuffer);
+
+        if (mDedicatedTransfer) {
+            vkDestroyFence(mDevice->GetDevice(), batch.transferFence, nullptr);
+            vkFreeCommandBuffers(mDevice->GetDevice(), mDevice->GetCommandPool(), 1, &batch.acquireCommandBuffer);
+        }
+    }
+}
+
+void UploadManager::UploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset) {
+    VkDeviceSize stagingOffset;
+    VkBuffer stagingBuffer = AllocateStaging(size, CopyFrom(data, size), stagingOffset);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = stagingOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+
+    VkCommandBuffer commandBuffer = GetCommandBuffer();
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+    if (!mDedicatedTransfer) {
+        mOpenBatch.hasBufferCopies = true;
+        return;
+    }
+
+    // release to the graphics family, the acquire repeats the barrier there
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = mDevice->GetTransferQueueFamily();
+    barrier.dstQueueFamilyIndex = mDevice->GetGraphicsQueueFamily();
+    barrier.buffer = dstBuffer;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, nullptr,
+        1, &barrier,
+        0, nullptr
+    );
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+    mOpenBatch.bufferAcquires.push_back(barrier);
+}
+
+void UploadManager::UploadSharedBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset) {
+    VkDeviceSize stagingOffset;
+    VkBuffer stagingBuffer = AllocateStaging(size, CopyFrom(data, size), stagingOffset);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = stagingOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+
+    VkCommandBuffer commandBuffer = GetCommandBuffer();
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+    if (!mDedicatedTransfer) {
+        mOpenBatch.hasBufferCopies = true;
+        return;
+    }
+
+    // the batch fence made the copy available, the acquire submission
+    // makes the range visible to the graphics queue
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = dstBuffer;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+
+    mOpenBatch.bufferAcquires.push_back(barrier);
+}
+
+void UploadManager::UploadImage(VkImage image,
+                                VkFormat format,
+                                uint32_t mipLevels,
+                                const std::vector<ImageLevel>& levels,
+                                const void *data,
+                                VkDeviceSize size) {
+    UploadImage(image, format, mipLevels, levels, size, CopyFrom(data, size));
+}
+
+void UploadManager::UploadImage(VkImage image,
+                                VkFormat format,
+                                uint32_t mipLevels,
+                                const std::vector<ImageLevel>& levels,
+                                VkDeviceSize size,
+                                const StagingWriter& write) {
+    VkDeviceSize stagingOffset;
+    VkBuffer stagingBuffer = AllocateStaging(size, write, stagingOffset);
+
+    VkCommandBuffer commandBuffer = GetCommandBuffer();
+
+    // levels that are generated stay undefined until the blits, see RecordMipBlits
+    uint32_t providedLevels = static_cast<uint32_t>(levels.size());
+    bool generateMips = providedLevels < mipLevels;
+
+    mDevice->RecordTransitionImageLayout(commandBuffer,
+                                         image,
+                                         format,
+                                         VK_IMAGE_LAYOUT_UNDEFINED,
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         providedLevels);
+
+    std::vector<VkBufferImageCopy> regions(providedLevels);
+
+    for (uint32_t level = 0; level < providedLevels; level++) {
+        regions[level].bufferOffset = stagingOffset + levels[level].offset;
+        regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[level].imageSubresource.mipLevel = level;
+        regions[level].imageSubresource.baseArrayLayer = 0;
+        regions[level].imageSubresource.layerCount = 1;
+        regions[level].imageExtent = {levels[level].width, levels[level].height, 1};
+    }
+
+    vkCmdCopyBufferToImage(commandBuffer,
+                           stagingBuffer,
+                           image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           providedLevels,
+                           regions.data());
+
+    if (!mDedicatedTransfer) {
+        if (generateMips) {
+            RecordMipBlits(commandBuffer, {image, levels[0].width, levels[0].height, providedLevels, mipLevels});
+        } else {
+            mDevice->RecordTransitionImageLayout(commandBuffer,
+                                                 image,
+                                                 format,
+                                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                 mipLevels);
+        }
+        return;
+    }
+
+    // the layout transition happens as part of the ownership transfer, both
+    // halves have to describe it identically. Blits need a graphics queue,
+    // so generated images are handed over still in the copy layout
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = generateMips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = mDevice->GetTransferQueueFamily();
+    barrier.dstQueueFamilyIndex = mDevice->GetGraphicsQueueFamily();
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = providedLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        0,
+        0, nullptr,
+        0, nullptr,
+        1, &barrier
+    );
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = generateMips ? VK_ACCESS_TRANSFER_READ_BIT : VK_ACCESS_SHADER_READ_BIT;
+    mOpenBatch.imageAcquires.push_back(barrier);
+
+    if (generateMips) {
+        mOpenBatch.mipJobs.push_back({image, levels[0].width, levels[0].height, providedLevels, mipLevels});
+    }
+}
+
+// Expects the copied levels in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL and the
+// generated ones undefined, leaves every level in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+void UploadManager::RecordMipBlits(VkCommandBuffer commandBuffer, const MipJob& job) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = job.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    // every generated level becomes a blit destination
+    barrier.subresourceRange.baseMipLevel = job.firstLevel;
+    barrier.subresourceRange.levelCount = job.mipLevels - job.firstLevel;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+
+    // copied levels other than the blit source are final already
+    if (job.firstLevel > 1) {
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = job.firstLevel - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &barrier);
+    }
+
+    barrier.subresourceRange.levelCount = 1;
+
+    int32_t width = static_cast<int32_t>(std::max(1u, job.width >> (job.firstLevel - 1)));
+    int32_t height = static_cast<int32_t>(std::max(1u, job.height >> (job.firstLevel - 1)));
+
+    for (uint32_t level = job.firstLevel; level < job.mipLevels; level++) {
+        // previous level is complete, read from it
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &barrier);
+
+        int32_t nextWidth = std::max(1, width / 2);
+        int32_t nextHeight = std::max(1, height / 2);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[1] = {width, height, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = level - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = level;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(commandBuffer,
+                       job.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       job.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit,
+                       VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                             0, nullptr,
+                             0, nullptr,
+                             1, &barrier);
+
+        width = nextWidth;
+        height = nextHeight;
+    }
+
+    // the last level is only ever written
+    barrier.subresourceRange.baseMipLevel = job.mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+}
+
+UploadManager::BatchId UploadManager::Flush() {
+    if (!mRecording) {
+        return mLastSubmittedBatch;
+    }
+
+    // make buffer copies visible to every later submission on the queue,
+    // images get the equivalent through their final layout transition
+    if (mOpenBatch.hasBufferCopies) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            mOpenBatch.commandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+            0,
+            1, &barrier,
+            0, nullptr,
+            0, nullptr
+        );
+    }
+
+    vkEndCommandBuffer(mOpenBatch.commandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &mOpenBatch.commandBuffer;
+
+    VkQueue queue = mDedicatedTransfer ? mDevice->GetTransferQueue() : mDevice->GetGraphicsQueue();
+    VkFence fence = mDedicatedTransfer ? mOpenBatch.transferFence : mOpenBatch.fence;
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit upload batch");
+    }
+
+    // nothing to hand over when the copies ran on the graphics queue
+    mOpenBatch.acquireSubmitted = !mDedicatedTransfer;
+    mOpenBatch.id = ++mLastSubmittedBatch;
+    mOpenBatch.stagingEnd = mStagingHead;
+
+    mInFlightBatches.push_back(std::move(mOpenBatch));
+    mOpenBatch = Batch{};
+    mRecording = false;
+
+    return mLastSubmittedBatch;
+}
+
+bool UploadManager::IsComplete(BatchId batchId) {
+    // nothing was recorded into the open batch, there is no upload to wait for
+    if (batchId == GetOpenBatch() && !mRecording) {
+        batchId--;
+    }
+
+    if (batchId > mLastCompletedBatch) {
+        RetireBatches(false);
+    }
+
+    return batchId <= mLastCompletedBatch;
+}
+
+void UploadManager::Wait(BatchId batchId) {
+    while (batchId > mLastCompletedBatch && !mInFlightBatches.empty()) {
+        RetireBatches(true);
+    }
+}
+
+UploadManager::StagingWriter UploadManager::CopyFrom(const void *data, VkDeviceSize size) {
+    return [data, size](void *dst) {
+        std::memcpy(dst, data, static_cast<size_t>(size));
+    };
+}
+
+VkBuffer UploadManager::AllocateStaging(VkDeviceSize size, const StagingWriter& write, VkDeviceSize &offset) {
+    if (size > mStagingSize) {
+        // never fits the ring, stage through a buffer owned by the batch
+        auto buffer = std::make_unique<Buffer>(mDevice,
+                                               size,
+                                               1,
+                                               VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                               1,
+                                               false,
+                                               MemoryCategory::STAGING);
+        buffer->Map();
+        write(buffer->GetMappedMemory());
+        buffer->Unmap();
+
+        VkBuffer stagingBuffer = buffer->GetBuffer();
+
+        GetCommandBuffer();
+        mOpenBatch.dedicatedStaging.push_back(std::move(buffer));
+
+        offset = 0;
+        return stagingBuffer;
+    }
+
+    while (true) {
+        // nothing outstanding, restart at the beginning of the ring
+        if (mStagingHead == mStagingTail && mInFlightBatches.empty()) {
+            mStagingHead = 0;
+            mStagingTail = 0;
+        }
+
+        VkDeviceSize start = AlignUp(mStagingHead, mStagingAlignment);
+        VkDeviceSize position = start % mStagingSize;
+
+        // allocations never wrap, skip the rest of the ring instead
+        if (position + size > mStagingSize) {
+            start += mStagingSize - position;
+            position = 0;
+        }
+
+        if (start + size - mStagingTail <= mStagingSize) {
+            mStagingHead = start + size;
+            write(mStagingMemory + position);
+
+            offset = position;
+            return mStagingBuffer->GetBuffer();
+        }
+
+        // ring is full, submit what is pending and reclaim the oldest batch
+        Flush();
+        RetireBatches(true);
+    }
+}
+
+VkCommandBuffer UploadManager::GetCommandBuffer() {
+    if (mRecording) {
+        return mOpenBatch.commandBuffer;
+    }
+
+    if (!mFreeBatches.empty()) {
+        mOpenBatch = std::move(mFreeBatches.back());
+        mFreeBatches.pop_back();
+
+        vkResetFences(mDevice->GetDevice(), 1, &mOpenBatch.fence);
+
+        if (mDedicatedTransfer) {
+            vkResetFences(mDevice->GetDevice(), 1, &mOpenBatch.transferFence);
+        }
+    } else {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = mDevice->GetTransferCommandPool();
+        allocInfo.commandBufferCount = 1;
+
+        if (vkAllocateCommandBuffers(mDevice->GetDevice(), &allocInfo, &mOpenBatch.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffer");
+        }
+
+        VkFenceCreateInfo fenceInfo{};
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        if (vkCreateFence(mDevice->GetDevice(), &fenceInfo, nullptr, &mOpenBatch.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload fence");
+        }
+
+        if (mDedicatedTransfer) {
+            allocInfo.commandPool = mDevice->GetCommandPool();
+
+            if (vkAllocateCommandBuffers(mDevice->GetDevice(), &allocInfo, &mOpenBatch.acquireCommandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate acquire command buffer");
+            }
+
+            if (vkCreateFence(mDevice->GetDevice(), &fenceInfo, nullptr, &mOpenBatch.transferFence) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create transfer fence");
+            }
+        }
+    }
+
+    // the pool allows resetting individual buffers, begin resets implicitly
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(mOpenBatch.commandBuffer, &beginInfo);
+    mRecording = true;
+
+    return mOpenBatch.commandBuffer;
+}
+
+void UploadManager::SubmitAcquire(Batch &batch) {
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(batch.acquireCommandBuffer, &beginInfo);
+
+    // the transfer already finished on the host timeline, so no semaphore
+    // is needed and the graphics queue never waits on the copies
+    vkCmdPipelineBarrier(
+        batch.acquireCommandBuffer,
+        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0,
+        0, nullptr,
+        static_cast<uint32_t>(batch.bufferAcquires.size()), batch.bufferAcquires.data(),
+        static_cast<uint32_t>(batch.imageAcquires.size()), batch.imageAcquires.data()
+    );
+
+    for (const auto& job : batch.mipJobs) {
+        RecordMipBlits(batch.acquireCommandBuffer, job);
+    }
+
+    vkEndCommandBuffer(batch.acquireCommandBuffer);
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.acquireCommandBuffer;
+
+    if (vkQueueSubmit(mDevice->GetGraphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit ownership acquire");
+    }
+
+    batch.acquireSubmitted = true;
+    batch.bufferAcquires.clear();
+    batch.imageAcquires.clear();
+    batch.mipJobs.clear();
+}
+
+bool UploadManager::IsSignaled(VkFence fence, bool wait) {
+    if (wait) {
+        vkWaitForFences(mDevice->GetDevice(), 1, &fence, VK_TRUE, UINT64_MAX);
+        return true;
+    }
+
+    return vkGetFenceStatus(mDevice->GetDevice(), fence) == VK_SUCCESS;
+}
+
+void UploadManager::RetireBatches(bool waitForOldest) {
+    while (!mInFlightBatches.empty()) {
+        Batch& batch = mInFlightBatches.front();
+
+        if (!batch.acquireSubmitted) {
+            if (!IsSignaled(batch.transferFence, waitForOldest)) {
+                break;
+            }
+
+            SubmitAcquire(batch);
+        }
+
+        if (!IsSignaled(batch.fence, waitForOldest)) {
+            break;
+        }
+
+        waitForOldest = false;
+
+        // batches complete in submission order
+        mLastCompletedBatch = batch.id;
+        mStagingTail = batch.stagingEnd;
+
+        batch.dedicatedStaging.clear();
+        batch.hasBufferCopies = false;
+
+        mFreeBatches.push_back(std::move(batch));
+        mInFlightBatches.pop_front();
+    }
+}
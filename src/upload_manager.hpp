@@ -0,0 +1,146 @@
+#pragma once
+
+#include <device.hpp>
+#include <buffer.hpp>
+
+// std
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Batches resource uploads into as few queue submissions as possible.
+// Source data is copied into one persistently mapped staging ring and the
+// copies are recorded into the command buffer of the open batch. Flush
+// submits the batch with a fence and returns its id; ids grow monotonically
+// and batches complete in order, so a single id tells whether an upload has
+// reached the GPU. Staging space is reclaimed when a batch retires.
+//
+// On devices with a dedicated transfer queue family the copies run there,
+// overlapping with rendering. Resources then change queue family ownership:
+// the transfer batch releases them, and once its fence has signaled a small
+// command buffer acquires them on the graphics queue. Polling for the fence
+// keeps the graphics queue from ever waiting on the copies.
+class UploadManager {
+public:
+    using BatchId = uint64_t;
+
+    static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 64 * 1024 * 1024;
+
+    // Fills the staging memory reserved for an upload, lets callers produce
+    // source data in place instead of copying it from an intermediate buffer
+    using StagingWriter = std::function<void(void *dst)>;
+
+    // One mip level of tightly packed source data, offset is relative to
+    // the data passed to UploadImage
+    struct ImageLevel {
+        VkDeviceSize offset;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    UploadManager(std::shared_ptr<Device> device, VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE);
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    void UploadBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+    // For buffers created sharedWithTransfer. Only the written range is
+    // synchronized and ownership never moves, so the rest of the buffer can
+    // be read by frames in flight meanwhile
+    void UploadSharedBuffer(VkBuffer dstBuffer, const void *data, VkDeviceSize size, VkDeviceSize dstOffset);
+
+    // Expects an image in VK_IMAGE_LAYOUT_UNDEFINED and leaves all of its
+    // mipLevels in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL. Levels missing
+    // from levels are generated from level 0 with linear blits, which the
+    // format must support (Device::SupportsLinearBlit).
+    void UploadImage(VkImage image,
+                     VkFormat format,
+                     uint32_t mipLevels,
+                     const std::vector<ImageLevel>& levels,
+                     const void *data,
+                     VkDeviceSize size);
+
+    // Same as above, with the size bytes of source data written by write
+    void UploadImage(VkImage image,
+                     VkFormat format,
+                     uint32_t mipLevels,
+                     const std::vector<ImageLevel>& levels,
+                     VkDeviceSize size,
+                     const StagingWriter& write);
+
+    // Submits everything recorded so far. Returns the id of the submitted
+    // batch, or of the last one if nothing was recorded.
+    BatchId Flush();
+
+    // Id of the batch uploads recorded now are submitted with, by whichever
+    // Flush comes next. Not complete before that Flush
+    BatchId GetOpenBatch() const { return mLastSubmittedBatch + 1; }
+
+    bool IsComplete(BatchId batchId);
+    void Wait(BatchId batchId);
+
+private:
+    struct MipJob {
+        VkImage image;
+        // extent of level 0
+        uint32_t width;
+        uint32_t height;
+        // levels below firstLevel were copied, the rest are generated
+        uint32_t firstLevel;
+        uint32_t mipLevels;
+    };
+
+    struct Batch {
+        BatchId id = 0;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        // signaled once the batch is usable by graphics work
+        VkFence fence = VK_NULL_HANDLE;
+        VkDeviceSize stagingEnd = 0;
+        bool hasBufferCopies = false;
+        std::vector<std::unique_ptr<Buffer>> dedicatedStaging;
+
+        // dedicated transfer queue only
+        VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+        VkFence transferFence = VK_NULL_HANDLE;
+        bool acquireSubmitted = false;
+        std::vector<VkBufferMemoryBarrier> bufferAcquires;
+        std::vector<VkImageMemoryBarrier> imageAcquires;
+        std::vector<MipJob> mipJobs;
+    };
+
+    static StagingWriter CopyFrom(const void *data, VkDeviceSize size);
+
+    // Reserves size bytes, fills them with write and returns the staging
+    // buffer and offset to copy from
+    VkBuffer AllocateStaging(VkDeviceSize size, const StagingWriter& write, VkDeviceSize &offset);
+    VkCommandBuffer GetCommandBuffer();
+    void RecordMipBlits(VkCommandBuffer commandBuffer, const MipJob& job);
+    void SubmitAcquire(Batch &batch);
+    bool IsSignaled(VkFence fence, bool wait);
+    void RetireBatches(bool waitForOldest);
+
+    std::shared_ptr<Device> mDevice;
+    bool mDedicatedTransfer;
+
+    std::unique_ptr<Buffer> mStagingBuffer;
+    char *mStagingMemory;
+    VkDeviceSize mStagingSize;
+    VkDeviceSize mStagingAlignment;
+
+    // monotonic byte counters, positions in the ring are taken modulo mStagingSize
+    VkDeviceSize mStagingHead = 0;
+    VkDeviceSize mStagingTail = 0;
+
+    Batch mOpenBatch;
+    bool mRecording = false;
+
+    std::deque<Batch> mInFlightBatches;
+    std::vector<Batch> mFreeBatches;
+
+    BatchId mLastSubmittedBatch = 0;
+    BatchId mLastCompletedBatch = 0;
+};
@@ -0,0 +1,358 @@
+// Uploads a buffer and two images through UploadManager on a headless
+// device and reads them back on the graphics queue. With --transfer the
+// copies run on a dedicated transfer family, covering the queue family
+// ownership transfer and the acquire submitted once the transfer fence has
+// signaled; devices without such a family skip that case.
+//
+// usage: UploadTest --graphics | --transfer
+//
+// Runs on any Vulkan driver, e.g. lavapipe without a GPU:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json ctest
+
+#include "buffer.hpp"
+#include "core/coordinator.hpp"
+#include "device.hpp"
+#include "upload_manager.hpp"
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+Coordinator gCoordinator(LogLevel::NORMAL);
+
+namespace {
+
+// ctest reports tests exiting with this as skipped, see SKIP_RETURN_CODE
+constexpr int SKIPPED = 77;
+
+constexpr VkFormat FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+struct Image
+{
+    VkImage image = VK_NULL_HANDLE;
+    MemoryAllocator::Allocation memory;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipLevels;
+};
+
+std::vector<unsigned char> Pattern(std::size_t size, unsigned seed)
+{
+    std::vector<unsigned char> data(size);
+
+    for (std::size_t i = 0; i < size; i++) {
+        data[i] = static_cast<unsigned char>((i * 31 + seed * 17 + (i >> 8)) & 0xff);
+    }
+
+    return data;
+}
+
+std::unique_ptr<Buffer> CreateReadback(std::shared_ptr<Device>& device, VkDeviceSize size)
+{
+    auto buffer = std::make_unique<Buffer>(device,
+                                           size,
+                                           1,
+                                           VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    buffer->Map();
+    return buffer;
+}
+
+// Makes uploaded data readable by copies recorded after it on the graphics queue
+void RecordTransferReadBarrier(VkCommandBuffer commandBuffer)
+{
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         1, &barrier,
+                         0, nullptr,
+                         0, nullptr);
+}
+
+bool Compare(const char* what, const void* actual, const void* expected, std::size_t size)
+{
+    if (std::memcmp(actual, expected, size) != 0) {
+        std::cerr << what << ": read back data differs from the upload\n";
+        return false;
+    }
+
+    return true;
+}
+
+Image CreateImage(std::shared_ptr<Device>& device, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+    Image image{};
+    image.width = width;
+    image.height = height;
+    image.mipLevels = mipLevels;
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent = {width, height, 1};
+    imageInfo.mipLevels = mipLevels;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = FORMAT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    device->CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image.image, image.memory);
+    return image;
+}
+
+void DestroyImage(std::shared_ptr<Device>& device, Image& image)
+{
+    vkDestroyImage(device->GetDevice(), image.image, nullptr);
+    device->GetAllocator().Free(image.memory);
+}
+
+// Copies every level of an image left in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+// into one tightly packed buffer, level after level
+std::unique_ptr<Buffer> ReadImage(std::shared_ptr<Device>& device, const Image& image)
+{
+    std::vector<VkBufferImageCopy> regions(image.mipLevels);
+    VkDeviceSize size = 0;
+
+    for (uint32_t level = 0; level < image.mipLevels; level++) {
+        uint32_t width = std::max(1u, image.width >> level);
+        uint32_t height = std::max(1u, image.height >> level);
+
+        regions[level] = {};
+        regions[level].bufferOffset = size;
+        regions[level].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[level].imageSubresource.mipLevel = level;
+        regions[level].imageSubresource.baseArrayLayer = 0;
+        regions[level].imageSubresource.layerCount = 1;
+        regions[level].imageExtent = {width, height, 1};
+
+        size += static_cast<VkDeviceSize>(width) * height * 4;
+    }
+
+    auto readback = CreateReadback(device, size);
+
+    VkCommandBuffer commandBuffer = device->BeginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image.image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = image.mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr,
+                         0, nullptr,
+                         1, &barrier);
+
+    vkCmdCopyImageToBuffer(commandBuffer,
+                           image.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           readback->GetBuffer(),
+                           image.mipLevels,
+                           regions.data());
+
+    device->EndSingleTimeCommands(commandBuffer);
+    return readback;
+}
+
+// ResourceManager publishes a synchronous load once the batch that was
+// open while recording it completes, which must not happen before a Flush
+bool TestOpenBatch(std::shared_ptr<Device>& device, UploadManager& uploadManager)
+{
+    constexpr VkDeviceSize SIZE = 1024;
+
+    auto data = Pattern(SIZE, 3);
+
+    Buffer buffer(device,
+                  SIZE,
+                  1,
+                  VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    uploadManager.UploadBuffer(buffer.GetBuffer(), data.data(), SIZE);
+    UploadManager::BatchId batch = uploadManager.GetOpenBatch();
+
+    if (uploadManager.IsComplete(batch)) {
+        std::cerr << "open batch: complete before it was submitted\n";
+        return false;
+    }
+
+    if (uploadManager.Flush() != batch) {
+        std::cerr << "open batch: submitted under another id\n";
+        return false;
+    }
+
+    uploadManager.Wait(batch);
+    return uploadManager.IsComplete(batch);
+}
+
+bool TestBuffer(std::shared_ptr<Device>& device, UploadManager& uploadManager)
+{
+    constexpr VkDeviceSize SIZE = 256 * 1024;
+    constexpr VkDeviceSize OFFSET = 4096;
+
+    auto data = Pattern(SIZE, 1);
+
+    Buffer buffer(device,
+                  OFFSET + SIZE,
+                  1,
+                  VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    uploadManager.UploadBuffer(buffer.GetBuffer(), data.data(), SIZE, OFFSET);
+    UploadManager::BatchId batch = uploadManager.Flush();
+
+    // polls like the renderer does, the acquire is submitted from here on a
+    // dedicated transfer queue
+    while (!uploadManager.IsComplete(batch)) {
+    }
+
+    auto readback = CreateReadback(device, SIZE);
+
+    VkCommandBuffer commandBuffer = device->BeginSingleTimeCommands();
+    RecordTransferReadBarrier(commandBuffer);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = OFFSET;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = SIZE;
+    vkCmdCopyBuffer(commandBuffer, buffer.GetBuffer(), readback->GetBuffer(), 1, &copyRegion);
+
+    device->EndSingleTimeCommands(commandBuffer);
+
+    return Compare("buffer", readback->GetMappedMemory(), data.data(), SIZE);
+}
+
+// every level supplied by the caller, copied as is
+bool TestImage(std::shared_ptr<Device>& device, UploadManager& uploadManager)
+{
+    constexpr uint32_t WIDTH = 64;
+    constexpr uint32_t HEIGHT = 32;
+    constexpr uint32_t MIP_LEVELS = 7;
+
+    std::vector<UploadManager::ImageLevel> levels;
+    VkDeviceSize size = 0;
+
+    for (uint32_t level = 0; level < MIP_LEVELS; level++) {
+        uint32_t width = std::max(1u, WIDTH >> level);
+        uint32_t height = std::max(1u, HEIGHT >> level);
+
+        levels.push_back({size, width, height});
+        size += static_cast<VkDeviceSize>(width) * height * 4;
+    }
+
+    auto data = Pattern(size, 2);
+    Image image = CreateImage(device, WIDTH, HEIGHT, MIP_LEVELS);
+
+    uploadManager.UploadImage(image.image, FORMAT, MIP_LEVELS, levels, data.data(), size);
+    uploadManager.Wait(uploadManager.Flush());
+
+    auto readback = ReadImage(device, image);
+    bool ok = Compare("image", readback->GetMappedMemory(), data.data(), size);
+
+    DestroyImage(device, image);
+    return ok;
+}
+
+// only level 0 supplied, the rest blitted on the graphics queue. A single
+// color survives any filter, so every level has to come back unchanged
+bool TestGeneratedMips(std::shared_ptr<Device>& device, UploadManager& uploadManager)
+{
+    constexpr uint32_t SIZE = 16;
+    constexpr uint32_t MIP_LEVELS = 5;
+    constexpr unsigned char COLOR[4] = {200, 100, 50, 255};
+
+    if (!device->SupportsLinearBlit(FORMAT)) {
+        std::cout << "generated mips: no linear blits, skipped\n";
+        return true;
+    }
+
+    std::vector<unsigned char> data(SIZE * SIZE * 4);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = COLOR[i % 4];
+    }
+
+    Image image = CreateImage(device, SIZE, SIZE, MIP_LEVELS);
+
+    uploadManager.UploadImage(image.image, FORMAT, MIP_LEVELS, {{0, SIZE, SIZE}}, data.data(), data.size());
+    uploadManager.Wait(uploadManager.Flush());
+
+    auto readback = ReadImage(device, image);
+    const auto* texels = static_cast<const unsigned char*>(readback->GetMappedMemory());
+
+    bool ok = true;
+    for (VkDeviceSize i = 0; i < readback->GetBufferSize(); i++) {
+        if (texels[i] != COLOR[i % 4]) {
+            std::cerr << "generated mips: texel byte " << i << " is " << int(texels[i]) << "\n";
+            ok = false;
+            break;
+        }
+    }
+
+    DestroyImage(device, image);
+    return ok;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string mode = argc == 2 ? argv[1] : "";
+
+    if (mode != "--graphics" && mode != "--transfer") {
+        std::cerr << "usage: " << argv[0] << " --graphics | --transfer\n";
+        return 1;
+    }
+
+    bool dedicatedTransfer = mode == "--transfer";
+
+    try {
+        auto device = std::make_shared<Device>(dedicatedTransfer);
+
+        if (device->HasDedicatedTransferQueue() != dedicatedTransfer) {
+            std::cout << "no dedicated transfer queue family, skipped\n";
+            return SKIPPED;
+        }
+
+        bool ok = true;
+        {
+            // the default ring is sized for whole scenes
+            UploadManager uploadManager(device, 1024 * 1024);
+
+            ok &= TestOpenBatch(device, uploadManager);
+            ok &= TestBuffer(device, uploadManager);
+            ok &= TestImage(device, uploadManager);
+            ok &= TestGeneratedMips(device, uploadManager);
+        }
+
+        std::cout << (ok ? "passed" : "FAILED") << "\n";
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
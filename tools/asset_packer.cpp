@@ -0,0 +1,184 @@
+// Bundles assets into one .pack archive with a sorted hash index. Entries
+// are named after their file stem, so "textures/chicken.vkft" is loaded as
+// "chicken". Cooked textures keep their header uncompressed in the entry
+// prefix; with --lz4 the rest of each entry is compressed when that saves
+// space.
+//
+// usage: AssetPacker [--lz4] <output.pack> <file>...
+
+#include "asset_pack_format.hpp"
+#include "cooked_texture_format.hpp"
+#include "core/io/lz4.hpp"
+#include "resource_handle.hpp"
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+struct PackedEntry
+{
+    PackFormat::Entry entry;
+    std::string name;
+    std::vector<char> data;
+};
+
+bool ReadFile(const std::filesystem::path& path, std::vector<char>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool Pack(const std::filesystem::path& path, bool compress, PackedEntry& packed)
+{
+    std::vector<char> contents;
+    if (!ReadFile(path, contents)) {
+        std::cerr << path.string() << ": cannot read\n";
+        return false;
+    }
+
+    packed.name = path.stem().string();
+    packed.entry = {};
+    packed.entry.id = MakeResourceId(packed.name);
+    packed.entry.size = contents.size();
+
+    if (path.extension() == CookedTexture::EXTENSION) {
+        CookedTexture::FileHeader header;
+
+        if (contents.size() < sizeof(header)) {
+            std::cerr << path.string() << ": not a cooked texture\n";
+            return false;
+        }
+
+        std::copy_n(contents.data(), sizeof(header), reinterpret_cast<char*>(&header));
+
+        packed.entry.type = PackFormat::EntryType::COOKED_TEXTURE;
+        packed.entry.prefixSize = static_cast<std::uint32_t>(
+            sizeof(header) + header.levelCount * sizeof(CookedTexture::LevelEntry));
+
+        if (header.magic != CookedTexture::MAGIC || packed.entry.prefixSize > contents.size()) {
+            std::cerr << path.string() << ": not a cooked texture\n";
+            return false;
+        }
+    }
+
+    const char* payload = contents.data() + packed.entry.prefixSize;
+    std::size_t payloadSize = contents.size() - packed.entry.prefixSize;
+
+    packed.data.assign(contents.cbegin(), contents.cbegin() + packed.entry.prefixSize);
+
+    if (compress && payloadSize > 0) {
+        std::vector<char> compressed(Lz4::CompressBound(payloadSize));
+        std::size_t compressedSize = Lz4::Compress(payload, payloadSize, compressed.data());
+
+        // not worth a decompression pass on load
+        if (compressedSize < payloadSize - payloadSize / 8) {
+            packed.entry.compression = PackFormat::Compression::LZ4;
+            packed.entry.storedSize = compressedSize;
+            packed.data.insert(packed.data.end(), compressed.data(), compressed.data() + compressedSize);
+            return true;
+        }
+    }
+
+    packed.entry.compression = PackFormat::Compression::NONE;
+    packed.entry.storedSize = payloadSize;
+    packed.data.insert(packed.data.end(), payload, payload + payloadSize);
+    return true;
+}
+
+std::uint64_t AlignEntry(std::uint64_t offset)
+{
+    return (offset + PackFormat::ENTRY_ALIGNMENT - 1) & ~(PackFormat::ENTRY_ALIGNMENT - 1);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    int first = 1;
+    bool compress = false;
+
+    if (argc > 1 && std::string(argv[1]) == "--lz4") {
+        compress = true;
+        first++;
+    }
+
+    if (argc - first < 2) {
+        std::cerr << "usage: " << argv[0] << " [--lz4] <output.pack> <file>...\n";
+        return 1;
+    }
+
+    std::filesystem::path output = argv[first];
+    std::vector<PackedEntry> entries;
+
+    for (int i = first + 1; i < argc; i++) {
+        PackedEntry packed;
+        if (!Pack(argv[i], compress, packed)) {
+            return 1;
+        }
+
+        entries.push_back(std::move(packed));
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const PackedEntry& a, const PackedEntry& b) {
+        return a.entry.id < b.entry.id;
+    });
+
+    for (std::size_t i = 1; i < entries.size(); i++) {
+        if (entries[i].entry.id == entries[i - 1].entry.id) {
+            std::cerr << entries[i - 1].name << " and " << entries[i].name << " have the same id\n";
+            return 1;
+        }
+    }
+
+    PackFormat::FileHeader header{};
+    header.magic = PackFormat::MAGIC;
+    header.version = PackFormat::VERSION;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+
+    std::uint64_t offset = sizeof(header) + entries.size() * sizeof(PackFormat::Entry);
+
+    for (auto& packed : entries) {
+        offset = AlignEntry(offset);
+        packed.entry.offset = offset;
+        offset += packed.data.size();
+    }
+
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& packed : entries) {
+        file.write(reinterpret_cast<const char*>(&packed.entry), sizeof(packed.entry));
+    }
+
+    for (const auto& packed : entries) {
+        std::uint64_t position = static_cast<std::uint64_t>(file.tellp());
+        std::vector<char> padding(packed.entry.offset - position, 0);
+
+        file.write(padding.data(), padding.size());
+        file.write(packed.data.data(), packed.data.size());
+
+        std::cout << packed.name << ": " << packed.entry.size << " -> "
+                  << packed.entry.prefixSize + packed.entry.storedSize << " bytes\n";
+    }
+
+    if (!file) {
+        std::cerr << output.string() << ": write failed\n";
+        return 1;
+    }
+
+    return 0;
+}
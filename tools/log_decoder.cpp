@@ -0,0 +1,319 @@
+// Renders binary logs written through the BINLOG_* macros as text, or
+// recovers the records kept in the segments of a memory-mapped file log.
+//
+// usage: LogDecoder <file.binlog>
+//        LogDecoder --mapped <segment.seg>...
+
+#include "core/io/binary_log_format.hpp"
+#include "core/io/mapped_log_format.hpp"
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+
+struct Format
+{
+    std::uint8_t level;
+    std::uint32_t line;
+    std::string file;
+    std::string format;
+    std::vector<BinaryLog::ArgType> argTypes;
+};
+
+const char* LevelName(std::uint8_t level)
+{
+    switch (level) {
+    case 0:
+        return "ERROR";
+    case 1:
+        return "INFO";
+    default:
+        return "DEBUG";
+    }
+}
+
+template<typename T>
+bool Read(const char*& cursor, const char* end, T& value)
+{
+    if (static_cast<std::size_t>(end - cursor) < sizeof(T)) {
+        return false;
+    }
+
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+// Appends the next argument to out, returns false if the record is truncated.
+bool RenderArg(BinaryLog::ArgType type, const char*& cursor, const char* end, std::ostream& out)
+{
+    switch (type) {
+    case BinaryLog::ArgType::BOOL: {
+        char value;
+        if (!Read(cursor, end, value)) return false;
+        out << (value ? "true" : "false");
+        return true;
+    }
+    case BinaryLog::ArgType::CHAR: {
+        char value;
+        if (!Read(cursor, end, value)) return false;
+        out << value;
+        return true;
+    }
+    case BinaryLog::ArgType::INT64: {
+        std::int64_t value;
+        if (!Read(cursor, end, value)) return false;
+        out << value;
+        return true;
+    }
+    case BinaryLog::ArgType::UINT64: {
+        std::uint64_t value;
+        if (!Read(cursor, end, value)) return false;
+        out << value;
+        return true;
+    }
+    case BinaryLog::ArgType::DOUBLE: {
+        double value;
+        if (!Read(cursor, end, value)) return false;
+        out << value;
+        return true;
+    }
+    case BinaryLog::ArgType::STRING: {
+        std::uint32_t length;
+        if (!Read(cursor, end, length) || static_cast<std::size_t>(end - cursor) < length) return false;
+        out.write(cursor, length);
+        cursor += length;
+        return true;
+    }
+    }
+
+    return false;
+}
+
+std::string RenderTimestamp(std::uint64_t timestamp)
+{
+    std::time_t seconds = static_cast<std::time_t>(timestamp / 1000000000ull);
+    std::tm time{};
+    localtime_r(&seconds, &time);
+
+    char buffer[64];
+    std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &time);
+    std::snprintf(buffer + length, sizeof(buffer) - length, ".%06llu",
+                  static_cast<unsigned long long>((timestamp / 1000ull) % 1000000ull));
+
+    return buffer;
+}
+
+void RenderMessage(const Format& format, const BinaryLog::MessageRecord& message,
+                   const char* cursor, const char* end, std::ostream& out)
+{
+    out << "[" << LevelName(format.level) << "]\t"
+        << RenderTimestamp(message.timestamp) << " [" << message.threadId << "] ";
+
+    std::size_t argIndex = 0;
+    bool truncated = false;
+
+    for (std::size_t i = 0; i < format.format.size(); ++i) {
+        if (format.format[i] == '{' && i + 1 < format.format.size() && format.format[i + 1] == '}') {
+            if (!truncated && argIndex < format.argTypes.size()) {
+                truncated = !RenderArg(format.argTypes[argIndex++], cursor, end, out);
+            }
+            if (truncated) {
+                out << "<truncated>";
+            }
+            ++i;
+        } else {
+            out << format.format[i];
+        }
+    }
+
+    out << " (" << format.file << ":" << format.line << ")\n";
+}
+
+bool ReadFile(const char* path, std::vector<char>& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "failed to open " << path << std::endl;
+        return false;
+    }
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+struct MappedSegment
+{
+    std::uint64_t sequence;
+    std::vector<char> data;
+};
+
+// Prints the committed records of every segment, oldest segment first. A
+// segment ends at the first record whose commit word does not match, which
+// is either unused space or a record interrupted by a crash.
+int DecodeMappedLog(int count, char** paths)
+{
+    std::vector<MappedSegment> segments;
+
+    for (int i = 0; i < count; ++i) {
+        MappedSegment segment{0, {}};
+        if (!ReadFile(paths[i], segment.data)) {
+            return EXIT_FAILURE;
+        }
+
+        const char* cursor = segment.data.data();
+        MappedLog::SegmentHeader header;
+
+        if (!Read(cursor, cursor + segment.data.size(), header) || header.magic != MappedLog::MAGIC) {
+            // preallocated but never used
+            continue;
+        }
+
+        if (header.version != MappedLog::VERSION) {
+            std::cerr << "unsupported mapped log version " << header.version << " in " << paths[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        segment.sequence = header.sequence;
+        segments.push_back(std::move(segment));
+    }
+
+    std::sort(segments.begin(), segments.end(), [](const MappedSegment& a, const MappedSegment& b) {
+        return a.sequence < b.sequence;
+    });
+
+    for (const auto& segment : segments) {
+        const char* cursor = segment.data.data() + sizeof(MappedLog::SegmentHeader);
+        const char* end = segment.data.data() + segment.data.size();
+
+        while (cursor < end) {
+            const char* recordStart = cursor;
+            MappedLog::RecordHeader header;
+
+            if (!Read(cursor, end, header) ||
+                header.commit != MappedLog::CommitWord(segment.sequence) ||
+                header.size < sizeof(header) + header.messageLength ||
+                static_cast<std::size_t>(end - recordStart) < header.size) {
+                break;
+            }
+
+            std::string_view subsystem(header.subsystem, strnlen(header.subsystem, sizeof(header.subsystem)));
+
+            std::cout << "[" << LevelName(header.level) << "]\t"
+                      << RenderTimestamp(header.timestamp) << " [" << header.threadId << "] "
+                      << subsystem << ": ";
+            std::cout.write(cursor, header.messageLength);
+            std::cout << "\n";
+
+            cursor = recordStart + header.size;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::string_view(argv[1]) == "--mapped") {
+        return DecodeMappedLog(argc - 2, argv + 2);
+    }
+
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <file.binlog>\n"
+                  << "       " << argv[0] << " --mapped <segment.seg>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<char> data;
+    if (!ReadFile(argv[1], data)) {
+        return EXIT_FAILURE;
+    }
+
+    const char* begin = data.data();
+    const char* end = data.data() + data.size();
+
+    BinaryLog::FileHeader fileHeader;
+    if (!Read(begin, end, fileHeader) || fileHeader.magic != BinaryLog::MAGIC) {
+        std::cerr << argv[1] << " is not a binary log" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (fileHeader.version != BinaryLog::VERSION) {
+        std::cerr << "unsupported binary log version " << fileHeader.version << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // records from different threads may arrive out of order, so collect
+    // every format before rendering messages
+    std::unordered_map<std::uint32_t, Format> formats;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        const char* cursor = begin;
+
+        while (cursor < end) {
+            const char* recordStart = cursor;
+            BinaryLog::RecordHeader header;
+
+            if (!Read(cursor, end, header) || header.size < sizeof(header) ||
+                static_cast<std::size_t>(end - recordStart) < header.size) {
+                if (pass == 1) {
+                    std::cerr << "stopping at truncated record" << std::endl;
+                }
+                break;
+            }
+
+            const char* recordEnd = recordStart + header.size;
+
+            if (header.type == BinaryLog::RecordType::FORMAT && pass == 0) {
+                BinaryLog::FormatRecord record;
+                if (Read(cursor, recordEnd, record) &&
+                    static_cast<std::size_t>(recordEnd - cursor) >= record.argCount) {
+                    Format format{record.level, record.line, {}, {}, {}};
+
+                    for (std::uint8_t i = 0; i < record.argCount; ++i) {
+                        format.argTypes.push_back(static_cast<BinaryLog::ArgType>(*cursor++));
+                    }
+
+                    format.file = std::string(cursor, strnlen(cursor, recordEnd - cursor));
+                    cursor += format.file.size() + 1;
+
+                    if (cursor < recordEnd) {
+                        format.format = std::string(cursor, strnlen(cursor, recordEnd - cursor));
+                    }
+
+                    formats[record.siteId] = std::move(format);
+                }
+            } else if (header.type == BinaryLog::RecordType::MESSAGE && pass == 1) {
+                BinaryLog::MessageRecord record;
+                if (Read(cursor, recordEnd, record)) {
+                    auto format = formats.find(record.siteId);
+
+                    if (format == formats.end()) {
+                        std::cout << "[?]\tmessage from unknown site " << record.siteId << "\n";
+                    } else {
+                        RenderMessage(format->second, record, cursor, recordEnd, std::cout);
+                    }
+                }
+            }
+
+            cursor = recordEnd;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
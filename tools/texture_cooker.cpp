@@ -0,0 +1,105 @@
+// Converts images into .vkft blobs the engine can upload without decoding:
+// RGBA8 sRGB pixels with the full mip chain generated ahead of time.
+//
+// usage: TextureCooker <output directory> <image>...
+
+#include "cooked_texture_format.hpp"
+#include "mip_generator.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+bool Cook(const std::filesystem::path& input, const std::filesystem::path& output)
+{
+    int width;
+    int height;
+    int channels;
+
+    std::unique_ptr<stbi_uc, void (*)(void*)> pixels{
+        stbi_load(input.string().c_str(), &width, &height, &channels, STBI_rgb_alpha),
+        stbi_image_free};
+
+    if (!pixels) {
+        std::cerr << input.string() << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+
+    CookedTexture::FileHeader header{};
+    header.magic = CookedTexture::MAGIC;
+    header.version = CookedTexture::VERSION;
+    header.format = CookedTexture::FORMAT_R8G8B8A8_SRGB;
+    header.width = static_cast<uint32_t>(width);
+    header.height = static_cast<uint32_t>(height);
+    header.levelCount = MipGenerator::MipLevelCount(header.width, header.height);
+
+    std::vector<CookedTexture::LevelEntry> levels(header.levelCount);
+
+    for (uint32_t level = 0; level < header.levelCount; level++) {
+        levels[level].offset = header.dataSize;
+        levels[level].width = std::max(1u, header.width >> level);
+        levels[level].height = std::max(1u, header.height >> level);
+        header.dataSize += static_cast<uint64_t>(levels[level].width) * levels[level].height * 4;
+    }
+
+    std::vector<unsigned char> data(header.dataSize);
+    std::copy_n(pixels.get(), levels[0].width * levels[0].height * 4, data.begin());
+
+    for (uint32_t level = 1; level < header.levelCount; level++) {
+        const CookedTexture::LevelEntry& src = levels[level - 1];
+        MipGenerator::DownsampleSrgbRgba8(data.data() + src.offset, src.width, src.height,
+                                          data.data() + levels[level].offset);
+    }
+
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levels.data()), levels.size() * sizeof(CookedTexture::LevelEntry));
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    if (!file) {
+        std::cerr << output.string() << ": write failed\n";
+        return false;
+    }
+
+    std::cout << input.string() << " -> " << output.string() << " ("
+              << header.width << "x" << header.height << ", " << header.levelCount << " levels)\n";
+    return true;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <output directory> <image>...\n";
+        return 1;
+    }
+
+    std::filesystem::path outputDirectory = argv[1];
+    std::filesystem::create_directories(outputDirectory);
+
+    bool ok = true;
+
+    for (int i = 2; i < argc; i++) {
+        std::filesystem::path input = argv[i];
+        std::filesystem::path output = outputDirectory / input.stem();
+        output += CookedTexture::EXTENSION;
+
+        ok &= Cook(input, output);
+    }
+
+    return ok ? 0 : 1;
+}